@@ -0,0 +1,184 @@
+/* Scheduler benchmark, writes one JSON record per configuration.
+ *
+ * Sweeps the number of workers, stations (capacity 1 each) and tasks.
+ * For every configuration it measures:
+ *  - add_task_per_s: add_task calls per second while one client submits
+ *    all the tasks in a burst, the plant works on them meanwhile,
+ *  - start_latency_ns: from a task becoming runnable (its add_task call)
+ *    to its worker starting, on tasks submitted one at a time,
+ *  - collect_latency_ns: from the worker returning to collect_task
+ *    returning, with the collector already waiting, on the same tasks,
+ *  - manager_pass_ns: mean cost of a manager pass during the burst.
+ *
+ * Usage: bench [output file, default stdout]
+ */
+#include "common/plant.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLES 200
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+static const int worker_counts[] = {1, 2, 4, 8};
+static const int task_counts[] = {1000, 10000};
+
+/* Filled by the work function, indexed by task id. */
+typedef struct {
+    int64_t started_ns;
+    int64_t finished_ns;
+} task_times_t;
+
+static task_times_t* times;
+
+static int work_fn(struct worker_t* w, task_t* t, int idx)
+{
+    times[t->id].started_ns = plant_now_ns();
+    volatile int acc = 0;
+    for (int i = 0; i < 2000; i++)
+        acc += i;
+    times[t->id].finished_ns = plant_now_ns();
+    return acc;
+}
+
+static void* xcalloc(size_t n, size_t size)
+{
+    void* mem = calloc(n, size);
+    if (!mem) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        fprintf(stderr, "bench: %s failed\n", what);
+        exit(1);
+    }
+}
+
+static int compare_ns(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void write_percentiles(FILE* out, const char* name, int64_t* ns, int n)
+{
+    qsort(ns, n, sizeof(int64_t), compare_ns);
+    fprintf(out, "\"%s\": {\"p50\": %lld, \"p99\": %lld, \"max\": %lld}", name,
+            (long long)ns[n / 2], (long long)ns[n * 99 / 100], (long long)ns[n - 1]);
+}
+
+static void run(FILE* out, int n_workers, int n_stations, int n_tasks, int first)
+{
+    int* stations = xcalloc(n_stations, sizeof(int));
+    worker_t* workers = xcalloc(n_workers, sizeof(worker_t));
+    task_t* tasks = xcalloc(n_tasks, sizeof(task_t));
+    task_t** task_ptrs = xcalloc(n_tasks, sizeof(task_t*));
+    int* results = xcalloc(n_tasks, sizeof(int));
+    int* status = xcalloc(n_tasks, sizeof(int));
+    int64_t* start_latency = xcalloc(SAMPLES, sizeof(int64_t));
+    int64_t* collect_latency = xcalloc(SAMPLES, sizeof(int64_t));
+    times = xcalloc(n_tasks, sizeof(task_times_t));
+
+    for (int i = 0; i < n_stations; i++)
+        stations[i] = 1;
+    plant_t* p = plant_create(stations, n_stations, n_workers, NULL);
+    check(p != NULL, "plant_create");
+
+    time_t now = time(NULL);
+    for (int i = 0; i < n_workers; i++) {
+        workers[i] = (worker_t) { .id = i, .start = now, .end = now + 3600, .work = work_fn };
+        check(plant_add_worker(p, &workers[i], NULL) == PLANTOK, "plant_add_worker");
+    }
+
+    /* One task at a time, so only the plant's own overhead is measured. */
+    for (int i = 0; i < SAMPLES; i++) {
+        tasks[i] = (task_t) { .id = i, .capacity = 1, .results = &results[i] };
+        int64_t runnable = plant_now_ns();
+        check(plant_add_task(p, &tasks[i], NULL) == PLANTOK, "plant_add_task");
+        check(plant_collect_task(p, &tasks[i]) == PLANTOK, "plant_collect_task");
+        int64_t collected = plant_now_ns();
+
+        start_latency[i] = times[i].started_ns - runnable;
+        collect_latency[i] = collected - times[i].finished_ns;
+    }
+
+    plant_stats_t before, after;
+    check(plant_get_stats(p, &before) == PLANTOK, "plant_get_stats");
+
+    for (int i = 0; i < n_tasks; i++) {
+        tasks[i] = (task_t) { .id = i, .capacity = 1, .results = &results[i] };
+        task_ptrs[i] = &tasks[i];
+    }
+    int64_t burst_start = plant_now_ns();
+    for (int i = 0; i < n_tasks; i++)
+        check(plant_add_task(p, &tasks[i], NULL) == PLANTOK, "plant_add_task");
+    int64_t burst_end = plant_now_ns();
+    check(plant_collect_tasks(p, task_ptrs, n_tasks, PLANT_WAIT_ALL, status) == PLANTOK,
+          "plant_collect_tasks");
+
+    check(plant_get_stats(p, &after) == PLANTOK, "plant_get_stats");
+    check(plant_destroy(p) == PLANTOK, "plant_destroy");
+
+    int64_t passes = after.manager_passes - before.manager_passes;
+    int64_t pass_ns = after.manager_pass_ns - before.manager_pass_ns;
+
+    fprintf(out, "%s  {\"workers\": %d, \"stations\": %d, \"tasks\": %d, ",
+            first ? "" : ",\n", n_workers, n_stations, n_tasks);
+    fprintf(out, "\"add_task_per_s\": %.0f, ", n_tasks * 1e9 / (double)(burst_end - burst_start));
+    write_percentiles(out, "start_latency_ns", start_latency, SAMPLES);
+    fprintf(out, ", ");
+    write_percentiles(out, "collect_latency_ns", collect_latency, SAMPLES);
+    fprintf(out, ", \"manager_passes\": %lld, \"manager_pass_ns\": %.0f}",
+            (long long)passes, passes > 0 ? (double)pass_ns / passes : 0.0);
+    fflush(out);
+
+    free(stations);
+    free(workers);
+    free(tasks);
+    free(task_ptrs);
+    free(results);
+    free(status);
+    free(start_latency);
+    free(collect_latency);
+    free(times);
+}
+
+int main(int argc, char** argv)
+{
+    FILE* out = stdout;
+    if (argc > 1) {
+        out = fopen(argv[1], "w");
+        if (!out) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    fprintf(out, "[\n");
+    int first = 1;
+    for (size_t w = 0; w < ARRAY_LEN(worker_counts); w++) {
+        int n_workers = worker_counts[w];
+        /* A single station, or one for every worker. */
+        int station_counts[] = {1, n_workers};
+        for (size_t s = 0; s < ARRAY_LEN(station_counts); s++) {
+            if (s > 0 && station_counts[s] == station_counts[s - 1])
+                continue;
+            for (size_t t = 0; t < ARRAY_LEN(task_counts); t++) {
+                run(out, n_workers, station_counts[s], task_counts[t], first);
+                first = 0;
+            }
+        }
+    }
+    fprintf(out, "\n]\n");
+
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,147 @@
+/* Effect of sticky worker assignment on memory-heavy work.
+ *
+ * Stations of capacity 1 .. STATIONS and as many workers as they hold
+ * together. A task of capacity c goes to the station of capacity c while it
+ * is free, and every worker of it reads the buffer of that capacity, so each
+ * station keeps reading the same data. The run is repeated with
+ * plant_options_t's `sticky_workers` off and on, writing one JSON record each:
+ *  - tasks_per_s: tasks completed per second, submitted in one burst,
+ *  - work_ns: how long the work function took (p50/p99), cold caches make
+ *    it slower.
+ *
+ * Usage: bench_locality [tasks, default 4000] [buffer KiB, default 256]
+ */
+#include "common/plant.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define STATIONS 4
+/* Ints in a cache line, the work reads one of each. */
+#define STRIDE 16
+
+static int buffer_ints;
+static int* buffers[STATIONS + 1];
+static int64_t* work_ns;
+
+static int work_fn(struct worker_t* w, task_t* t, int idx)
+{
+    int64_t from = plant_now_ns();
+    int acc = 0;
+    for (int pass = 0; pass < 4; pass++) {
+        for (int i = 0; i < buffer_ints; i += STRIDE)
+            acc += t->data[i];
+    }
+    if (idx == 0)
+        work_ns[t->id] = plant_now_ns() - from;
+    return acc;
+}
+
+static void* xcalloc(size_t n, size_t size)
+{
+    void* mem = calloc(n, size);
+    if (!mem) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        fprintf(stderr, "bench: %s failed\n", what);
+        exit(1);
+    }
+}
+
+static int compare_ns(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run(int n_tasks, bool sticky, int first)
+{
+    int stations[STATIONS];
+    int n_workers = 0;
+    for (int i = 0; i < STATIONS; i++) {
+        stations[i] = i + 1;
+        n_workers += i + 1;
+    }
+
+    plant_options_t opts = { .sticky_workers = sticky };
+    plant_t* p = plant_create(stations, STATIONS, n_workers, &opts);
+    check(p != NULL, "plant_create");
+
+    worker_t* workers = xcalloc(n_workers, sizeof(worker_t));
+    time_t now = time(NULL);
+    for (int i = 0; i < n_workers; i++) {
+        workers[i] = (worker_t) { .id = i, .start = now, .end = now + 3600, .work = work_fn };
+        check(plant_add_worker(p, &workers[i], NULL) == PLANTOK, "plant_add_worker");
+    }
+
+    task_t* tasks = xcalloc(n_tasks, sizeof(task_t));
+    task_t** task_ptrs = xcalloc(n_tasks, sizeof(task_t*));
+    int* results = xcalloc((size_t)n_tasks * STATIONS, sizeof(int));
+    int* status = xcalloc(n_tasks, sizeof(int));
+    work_ns = xcalloc(n_tasks, sizeof(int64_t));
+
+    for (int i = 0; i < n_tasks; i++) {
+        int capacity = i % STATIONS + 1;
+        tasks[i] = (task_t) {
+            .id = i,
+            .capacity = capacity,
+            .data = buffers[capacity],
+            .results = &results[(size_t)i * STATIONS],
+        };
+        task_ptrs[i] = &tasks[i];
+    }
+
+    int64_t from = plant_now_ns();
+    check(plant_add_tasks(p, task_ptrs, n_tasks) == PLANTOK, "plant_add_tasks");
+    check(plant_collect_tasks(p, task_ptrs, n_tasks, PLANT_WAIT_ALL, status) == PLANTOK,
+          "plant_collect_tasks");
+    int64_t to = plant_now_ns();
+    check(plant_destroy(p) == PLANTOK, "plant_destroy");
+
+    qsort(work_ns, n_tasks, sizeof(int64_t), compare_ns);
+    printf("%s  {\"sticky_workers\": %s, \"tasks\": %d, \"buffer_kib\": %zu, ",
+           first ? "" : ",\n", sticky ? "true" : "false", n_tasks,
+           (size_t)buffer_ints * sizeof(int) / 1024);
+    printf("\"tasks_per_s\": %.0f, ", n_tasks * 1e9 / (double)(to - from));
+    printf("\"work_ns\": {\"p50\": %lld, \"p99\": %lld}}",
+           (long long)work_ns[n_tasks / 2], (long long)work_ns[n_tasks * 99 / 100]);
+    fflush(stdout);
+
+    free(workers);
+    free(tasks);
+    free(task_ptrs);
+    free(results);
+    free(status);
+    free(work_ns);
+}
+
+int main(int argc, char** argv)
+{
+    int n_tasks = argc > 1 ? atoi(argv[1]) : 4000;
+    int buffer_kib = argc > 2 ? atoi(argv[2]) : 256;
+    check(n_tasks > 0 && buffer_kib > 0, "parsing arguments");
+
+    buffer_ints = buffer_kib * 1024 / (int)sizeof(int);
+    for (int i = 1; i <= STATIONS; i++) {
+        buffers[i] = xcalloc(buffer_ints, sizeof(int));
+        for (int j = 0; j < buffer_ints; j++)
+            buffers[i][j] = i + j;
+    }
+
+    printf("[\n");
+    run(n_tasks, false, 1);
+    run(n_tasks, true, 0);
+    printf("\n]\n");
+
+    for (int i = 1; i <= STATIONS; i++)
+        free(buffers[i]);
+    return 0;
+}
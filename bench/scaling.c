@@ -0,0 +1,140 @@
+/* Throughput of the plant as threads are added.
+ *
+ * For every thread count T the plant gets T stations, T workers and T pool
+ * threads, and T client threads submit and collect short tasks in batches.
+ * Prints one line per T with completed tasks per second.
+ *
+ * Usage: bench_scaling [tasks per client] [max threads]
+ */
+#include "common/plant.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH 64
+
+static int tasks_per_client = 20000;
+
+typedef struct {
+    int client;
+} client_arg_t;
+
+static int work_fn(struct worker_t* w, task_t* t, int idx)
+{
+    volatile int acc = 0;
+    for (int i = 0; i < 200; i++)
+        acc += i;
+    return acc;
+}
+
+static double elapsed_s(const struct timespec* from, const struct timespec* to)
+{
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+static void* client_func(void* arg)
+{
+    client_arg_t* c = arg;
+    task_t* tasks = calloc(BATCH, sizeof(task_t));
+    int* results = calloc(BATCH, sizeof(int));
+    if (!tasks || !results) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+
+    for (int done = 0; done < tasks_per_client; done += BATCH) {
+        int n = tasks_per_client - done < BATCH ? tasks_per_client - done : BATCH;
+        for (int i = 0; i < n; i++) {
+            tasks[i] = (task_t) {
+                .id = c->client * tasks_per_client + done + i,
+                .start = 0,
+                .capacity = 1,
+                .results = &results[i],
+            };
+            if (add_task(&tasks[i]) != PLANTOK) {
+                fprintf(stderr, "bench: add_task failed\n");
+                exit(1);
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            if (collect_task(&tasks[i]) != PLANTOK) {
+                fprintf(stderr, "bench: collect_task failed\n");
+                exit(1);
+            }
+        }
+    }
+
+    free(tasks);
+    free(results);
+    return NULL;
+}
+
+static double run(int n_threads)
+{
+    int* stations = malloc(sizeof(int) * n_threads);
+    worker_t* workers = calloc(n_threads, sizeof(worker_t));
+    pthread_t* clients = malloc(sizeof(pthread_t) * n_threads);
+    client_arg_t* args = malloc(sizeof(client_arg_t) * n_threads);
+    if (!stations || !workers || !clients || !args) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < n_threads; i++)
+        stations[i] = 1;
+
+    plant_options_t options = { .pool_threads = n_threads };
+    if (init_plant_ex(stations, n_threads, n_threads, &options) != PLANTOK) {
+        fprintf(stderr, "bench: init_plant failed\n");
+        exit(1);
+    }
+
+    time_t now = time(NULL);
+    for (int i = 0; i < n_threads; i++) {
+        workers[i] = (worker_t) { .id = i, .start = now, .end = now + 3600, .work = work_fn };
+        add_worker(&workers[i]);
+    }
+
+    struct timespec from, to;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    for (int i = 0; i < n_threads; i++) {
+        args[i].client = i;
+        if (pthread_create(&clients[i], NULL, client_func, &args[i]) != 0) {
+            fprintf(stderr, "bench: pthread_create failed\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < n_threads; i++)
+        pthread_join(clients[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &to);
+
+    destroy_plant();
+
+    free(stations);
+    free(workers);
+    free(clients);
+    free(args);
+    return (double)n_threads * tasks_per_client / elapsed_s(&from, &to);
+}
+
+int main(int argc, char** argv)
+{
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc > 1)
+        tasks_per_client = atoi(argv[1]);
+    if (argc > 2)
+        max_threads = atoi(argv[2]);
+    if (tasks_per_client <= 0 || max_threads <= 0) {
+        fprintf(stderr, "usage: %s [tasks per client] [max threads]\n", argv[0]);
+        return 1;
+    }
+
+    printf("threads  tasks/s\n");
+    for (int n = 1; n <= max_threads; n = n * 2 > max_threads && n < max_threads ? max_threads : n * 2)
+        printf("%7d  %.0f\n", n, run(n));
+
+    return 0;
+}
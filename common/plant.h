@@ -1,72 +1,291 @@
-#pragma once
-
-#include <time.h>
-
-////////////////////ERRORS///////////////////////////////
-#define PLANTOK 0
-#define ERROR -1
-
-////////////////////TYPE DEFINITIONS//////////////////////
-// Function type for task_t's task_function.
-typedef int (*task_function_t)(int);
-
-/*
- * A task to be executed by many workers.
- *@id: a unique task id.
- *@start: earliest possible start time for the task.
- *@task_function: the function to be called by each worker (`capacity` times).
- *@capacity: the number of workers needed to perform the task.
- *@data: array of size `capacity` with arguments to be used by workers when calling `task_function`.
- *@results: array of size `capacity` to store results computed by workers.
- */
-typedef struct task_t {
-    int id;
-    time_t start;
-    task_function_t task_function;
-    int capacity;
-    int* data;
-    int* results;
-} task_t;
-
-// Forward declaration.
-struct worker_t;
-
-/* Function type for worker's work function.
- * @w: pointer to the worker_t performing the task.
- * @t: pointer to the task being performed.
- * @i: index of the worker in the task's capacity (0 .. capacity-1).
- */
-typedef int (*worker_function_t)(struct worker_t* w, task_t* t, int i);
-
-/* A worker in the plant.
- * @id: a unique worker id.
- * @start: the worker's start time.
- * @end: the worker's end time.
- * @work: the performing function of the worker.
- */
-typedef struct worker_t {
-    int id;
-    time_t start;
-    time_t end;
-    worker_function_t work;
-} worker_t;
-
-///////////////////////////FUNCTIONALITY///////////////////////
-
-// Initialize the plant.
-// @stations: array of size `n_stations` of station capacities.
-// @n_stations: number of stations in the plant.
-// @n_workers: number of workers in the plant.
-int init_plant(int* stations, int n_stations, int n_workers);
-
-// Clean up plant resources.
-int destroy_plant();
-
-// Register a new worker.
-int add_worker(worker_t* w);
-
-// Register a new task.
-int add_task(task_t* t);
-
-// Collect the results of the task (blocking).
-int collect_task(task_t* t);
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+////////////////////ERRORS///////////////////////////////
+#define PLANTOK 0
+#define ERROR -1
+
+////////////////////TYPE DEFINITIONS//////////////////////
+// Function type for task_t's task_function.
+typedef int (*task_function_t)(int);
+
+// Batch variant of task_function_t, see task_attr_t's `batch_function`.
+// Fills out[0 .. n) from in[0 .. n) in one call.
+typedef void (*task_batch_function_t)(const int* in, int* out, int n);
+
+/*
+ * A task to be executed by many workers.
+ *@id: a unique task id.
+ *@start: earliest possible start time for the task.
+ *@task_function: the function to be called by each worker (`capacity` times).
+ *@capacity: the number of workers needed to perform the task.
+ *@data: array of size `capacity` with arguments to be used by workers when calling `task_function`.
+ *@results: array of size `capacity` to store results computed by workers.
+ */
+typedef struct task_t {
+    int id;
+    time_t start;
+    task_function_t task_function;
+    int capacity;
+    int* data;
+    int* results;
+} task_t;
+
+// Forward declaration.
+struct worker_t;
+
+/* Function type for worker's work function.
+ * @w: pointer to the worker_t performing the task.
+ * @t: pointer to the task being performed.
+ * @i: index of the worker in the task's capacity (0 .. capacity-1).
+ */
+typedef int (*worker_function_t)(struct worker_t* w, task_t* t, int i);
+
+/* A worker in the plant.
+ * @id: a unique worker id.
+ * @start: the worker's start time.
+ * @end: the worker's end time.
+ * @work: the performing function of the worker.
+ */
+typedef struct worker_t {
+    int id;
+    time_t start;
+    time_t end;
+    worker_function_t work;
+} worker_t;
+
+/* CPUs given by their numbers, for pinning the threads doing the work.
+ * An empty set (`n_cpus` 0) means no pinning.
+ */
+typedef struct plant_cpu_set_t {
+    const int* cpus;
+    int n_cpus;
+} plant_cpu_set_t;
+
+/* Optional task attributes, see add_task_ex().
+ * Times are nanoseconds of the plant clock (CLOCK_MONOTONIC, see plant_now_ns()).
+ *@start_ns: earliest possible start, used instead of task_t's `start` if non-zero.
+ *@priority: with PLANT_ORDER_PRIORITY, tasks of higher priority get stations and workers first.
+ *@deadline_ns: with PLANT_ORDER_PRIORITY, among tasks of equal priority the earliest
+ *              deadline goes first, 0 goes after any deadline. Only orders the tasks,
+ *              a task past its deadline still runs.
+ *@expected_ns: how long the task is expected to run once started, 0 if unknown.
+ *              With `backfill` it may start ahead of the reserved task if it ends
+ *              before that one can start.
+ *@batch_function: if set, each worker calls it once on its contiguous slice of
+ *                 `data` and `results` instead of calling its work function, so
+ *                 the function can use SIMD and is called only once per worker.
+ *@n_items: with `batch_function`, the size of `data` and `results`, split evenly
+ *          between the `capacity` workers. 0 means `capacity`.
+ *@min_capacity: if non-zero and below `capacity`, the task may start with as few
+ *               workers, taking as many of up to `capacity` as are free then. The
+ *               indices (or `n_items`) are split into contiguous ranges between
+ *               them, a worker calls its work function once for every index of its range.
+ *@padded_results: workers store their results in private cache-line-sized slots,
+ *                 copied into `results` by the last one. For wide tasks, whose
+ *                 workers would otherwise keep writing to the same cache line.
+ *                 Ignored with `batch_function`, whose slices only share their ends.
+ */
+typedef struct task_attr_t {
+    int64_t start_ns;
+    int priority;
+    int64_t deadline_ns;
+    int64_t expected_ns;
+    task_batch_function_t batch_function;
+    int n_items;
+    int min_capacity;
+    bool padded_results;
+} task_attr_t;
+
+/* Optional worker attributes, see add_worker_ex().
+ *@start_ns: the worker's start time, used instead of worker_t's `start` if non-zero.
+ *@end_ns: the worker's end time, used instead of worker_t's `end` if non-zero.
+ *@cpus: CPUs the worker works on, unless its station has CPUs of its own.
+ */
+typedef struct worker_attr_t {
+    int64_t start_ns;
+    int64_t end_ns;
+    plant_cpu_set_t cpus;
+} worker_attr_t;
+
+// For plant_options_t's `order`: in which order waiting tasks get stations and workers.
+typedef enum plant_order_t {
+    PLANT_ORDER_FIFO,      // the order they became ready in
+    PLANT_ORDER_PRIORITY,  // by task_attr_t's `priority`, then `deadline_ns`
+} plant_order_t;
+
+// For plant_options_t's `pool_threads`: one pool thread per online core.
+#define PLANT_POOL_PER_CORE -1
+
+/* Optional plant configuration, see init_plant_ex().
+ *@pool_threads: 0 gives every worker its own thread for its whole shift.
+ *               Otherwise workers share this many threads and are bound to one
+ *               only while performing their work (PLANT_POOL_PER_CORE: one per core).
+ *@station_cpus: NULL or array of size `n_stations`. Workers serving a station
+ *               work on its CPUs, e.g. the ones of a single NUMA node.
+ *@order: see plant_order_t.
+ *@backfill: the widest waiting task reserves the workers and the station it
+ *           will get once enough work ends, so narrower tasks can't keep it
+ *           waiting forever. They only go ahead of it if they are expected to
+ *           end in time (see task_attr_t's `expected_ns`), or if they don't
+ *           need anything it waits for.
+ *@sticky_workers: a task gets the idle workers that last worked at its station
+ *                 first, so the data the station's tasks share stays warm in
+ *                 their caches. Workers leaving first are preferred otherwise.
+ */
+typedef struct plant_options_t {
+    int pool_threads;
+    const plant_cpu_set_t* station_cpus;
+    plant_order_t order;
+    bool backfill;
+    bool sticky_workers;
+} plant_options_t;
+
+// Modes of collect_tasks(): wait for every task, or for at least one of them.
+typedef enum plant_wait_t {
+    PLANT_WAIT_ALL,
+    PLANT_WAIT_ANY,
+} plant_wait_t;
+
+// collect_tasks() status of a task that wasn't complete yet (PLANT_WAIT_ANY only).
+#define PLANT_PENDING 1
+
+/* Completion callback, see collect_task_async(). Runs on a plant thread,
+ * must not block nor collect tasks itself.
+ *@status: what collect_task() would return for the task.
+ */
+typedef void (*task_callback_t)(task_t* t, int status, void* arg);
+
+/* Counters of a plant since it was initialized, see plant_get_stats().
+ *@tasks_submitted: tasks given to add_task() and the like.
+ *@tasks_started: tasks that got their station and workers.
+ *@tasks_completed: tasks done by their workers.
+ *@tasks_infeasible: tasks failed, because they couldn't get a station or workers.
+ *@manager_wakeups: times the manager thread woke up from sleeping.
+ *@manager_passes: scheduling passes of the manager thread.
+ *@manager_pass_ns: time the manager spent in them, without its sleeps.
+ *@tasks_examined: tasks looked at by the passes (divide by `manager_passes` for a mean).
+ *@worker_busy_ns: time spent in work functions, summed over the workers.
+ *@worker_idle_ns: time threads doing the work (worker or pool threads) waited for it.
+ *@stations_busy: stations held by tasks right now.
+ *@station_busy_ns: time stations were held by tasks, summed over the stations.
+ *@main_lock_wait_ns: time threads waited for the plant's main lock.
+ */
+typedef struct plant_stats_t {
+    int64_t tasks_submitted;
+    int64_t tasks_started;
+    int64_t tasks_completed;
+    int64_t tasks_infeasible;
+    int64_t manager_wakeups;
+    int64_t manager_passes;
+    int64_t manager_pass_ns;
+    int64_t tasks_examined;
+    int64_t worker_busy_ns;
+    int64_t worker_idle_ns;
+    int64_t stations_busy;
+    int64_t station_busy_ns;
+    int64_t main_lock_wait_ns;
+} plant_stats_t;
+
+// Handle of one plant, see plant_create(). Functions taking a handle use
+// the plant of init_plant() when given NULL.
+typedef struct plant plant_t;
+
+///////////////////////////FUNCTIONALITY///////////////////////
+
+// Initialize the plant.
+// @stations: array of size `n_stations` of station capacities.
+// @n_stations: number of stations in the plant.
+// @n_workers: number of workers in the plant.
+int init_plant(int* stations, int n_stations, int n_workers);
+
+// Initialize the plant, `options` may be NULL.
+int init_plant_ex(int* stations, int n_stations, int n_workers, const plant_options_t* options);
+
+// Clean up plant resources.
+int destroy_plant();
+
+// Register a new worker, the plant picks it up asynchronously.
+int add_worker(worker_t* w);
+
+// Register a new worker, `attr` may be NULL.
+int add_worker_ex(worker_t* w, const worker_attr_t* attr);
+
+// Register `n` workers at once, either all of them or none.
+int add_workers(worker_t** w, int n);
+
+// Register a new task, the plant picks it up asynchronously.
+int add_task(task_t* t);
+
+// Register a new task, `attr` may be NULL.
+int add_task_ex(task_t* t, const task_attr_t* attr);
+
+// Register `n` tasks at once, either all of them or none.
+int add_tasks(task_t** t, int n);
+
+// Create an independent plant, `options` may be NULL. Returns NULL on failure.
+plant_t* plant_create(int* stations, int n_stations, int n_workers, const plant_options_t* options);
+
+// Wait for the plant like destroy_plant() does and free it.
+int plant_destroy(plant_t* p);
+
+// Same as the functions without a handle, for the plant `p`.
+int plant_add_worker(plant_t* p, worker_t* w, const worker_attr_t* attr);
+int plant_add_workers(plant_t* p, worker_t** w, int n);
+int plant_add_task(plant_t* p, task_t* t, const task_attr_t* attr);
+int plant_add_tasks(plant_t* p, task_t** t, int n);
+int plant_collect_task(plant_t* p, task_t* t);
+int plant_collect_tasks(plant_t* p, task_t** t, int n, plant_wait_t mode, int* status);
+int plant_collect_task_async(plant_t* p, task_t* t, task_callback_t cb, void* arg);
+
+// Current time of the plant clock in nanoseconds.
+int64_t plant_now_ns(void);
+
+// Allocate `size` zeroed bytes first touched from `cpus`, so on a NUMA machine
+// they live on the node of the station they are meant for (e.g. a task's data
+// and results). `cpus` may be NULL. Free with free().
+void* plant_alloc_on_cpus(const plant_cpu_set_t* cpus, size_t size);
+
+// Collect the results of the task (blocking).
+// Afterwards the plant forgets the task, so its id may be used again.
+int collect_task(task_t* t);
+
+// Collect `n` tasks at once (blocking, see plant_wait_t).
+// @status: array of size `n`, gets what collect_task() would return for each
+//          task, or PLANT_PENDING for a task that may still be collected later.
+int collect_tasks(task_t** t, int n, plant_wait_t mode, int* status);
+
+// Collect the task without blocking. Once it is complete `cb(t, status, arg)`
+// is called, or with `cb` NULL the task is reported by plant_drain_completed().
+// The plant forgets the task once it has been reported.
+int collect_task_async(task_t* t, task_callback_t cb, void* arg);
+
+// Read the counters of the plant `p` (NULL: the default one). They are kept
+// per thread and summed here, so they're cheap enough to always be on.
+int plant_get_stats(plant_t* p, plant_stats_t* stats);
+
+// Start recording the lifecycle of every task of every plant (add_task, worker
+// assignment, work of each worker, completion and collection). Every thread
+// keeps its last `events_per_thread` events. Starting again drops them.
+int plant_trace_start(int events_per_thread);
+
+// Stop recording, the events are kept.
+void plant_trace_stop(void);
+
+// Write the recorded events to `path` as Chrome trace-event JSON, for
+// chrome://tracing or Perfetto. It may run while tasks are traced, events
+// written meanwhile are left out.
+int plant_trace_dump(const char* path);
+
+// Eventfd of the plant, readable while plant_drain_completed() has tasks to report.
+int plant_completion_fd(plant_t* p);
+
+// Reports up to `max` completed tasks collected by collect_task_async() without
+// a callback, in the order they completed: their ids go to `ids` and their
+// statuses to `status`. The ones that don't fit are reported by the next call.
+// Doesn't wait, returns the number of reported tasks or ERROR.
+int plant_drain_completed(plant_t* p, int* ids, int* status, int max);
@@ -1,607 +1,2199 @@
-#define _XOPEN_SOURCE 600
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <time.h>
-#include <stdbool.h>
-#include <pthread.h>
-#include <assert.h>
-#include <math.h>
-
-// Adjust paths to match your project structure
-#include "../common/err.h"
-#include "../common/plant.h"
-
-/* -------------------------------------------------------------------------- */
-/*                                Test Helpers                                */
-/* -------------------------------------------------------------------------- */
-
-#define GREEN "\033[0;32m"
-#define RED   "\033[0;31m"
-#define RESET "\033[0m"
-
-#define TEST_PASS() printf(GREEN "PASS\n" RESET)
-#define TEST_FAIL(msg) do { printf(RED "FAIL: %s (Line %d)\n" RESET, msg, __LINE__); return -1; } while(0)
-
-// Helper to allocate result memory (int*)
-void setup_task_memory(task_t* t, int capacity) {
-    t->results = (int*)malloc(sizeof(int) * capacity);
-}
-
-void cleanup_task_memory(task_t* t) {
-    if (t->results) free(t->results);
-}
-
-// Simple work function: returns 1
-int work_fn_simple(worker_t* worker, task_t* task, int aux) {
-    usleep(10000); // 10ms work
-    return 1;
-}
-
-/* -------------------------------------------------------------------------- */
-/*                                 Scenarios                                  */
-/* -------------------------------------------------------------------------- */
-
-/**
- * Scenario 1: The "Zombie" Worker (Your specific example)
- * 
- * Condition: Worker is available [Now, Now+1].
- *            Task starts at [Now+3].
- * 
- * Expected: Task cannot be started because by the time it reaches start time,
- *           the worker has gone home.
- *           collect_task should return ERROR (task skipped).
- */
-int test_worker_ends_before_task_starts() {
-    printf("Test 1: Worker ends shift before task starts... ");
-    fflush(stdout);
-
-    int stations[] = {1};
-    if (init_plant(stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
-
-    time_t now = time(NULL);
-
-    // Worker works for only 1 second
-    worker_t w = { .id = 1, .start = now, .end = now + 1, .work = work_fn_simple };
-    add_worker(&w);
-
-    // Task starts in 3 seconds
-    task_t t = { .id = 100, .start = now + 3, .capacity = 1 };
-    setup_task_memory(&t, 1);
-    add_task(&t);
-
-    // Should return ERROR because task is skipped (impossible to schedule)
-    int res = collect_task(&t);
-    cleanup_task_memory(&t);
-    destroy_plant();
-
-    if (res == ERROR) {
-        TEST_PASS();
-        return 0;
-    } else {
-        TEST_FAIL("Task should have been skipped (returned ERROR), but returned PLANTOK");
-    }
-}
-
-/**
- * Scenario 2: The "Patient" Destroyer
- * 
- * Condition: Task starts in the future (T+2).
- *            We call destroy_plant() immediately at T+0.
- * 
- * Expected: destroy_plant() MUST NOT exit immediately. 
- *           It must wait for the task to become active, execute, and finish.
- *           Execution time should be approx 2 seconds.
- */
-int test_destroy_waits_for_future() {
-    printf("Test 2: Destroy waits for future task... ");
-    fflush(stdout);
-
-    int stations[] = {1};
-    init_plant(stations, 1, 1);
-
-    time_t now = time(NULL);
-
-    // Worker is available for a long time
-    worker_t w = { .id = 1, .start = now, .end = now + 10, .work = work_fn_simple };
-    add_worker(&w);
-
-    // Task starts in 2 seconds
-    task_t t = { .id = 200, .start = now + 2, .capacity = 1 };
-    setup_task_memory(&t, 1);
-    add_task(&t);
-    // We do NOT call collect_task. We go straight to destroy.
-    // destroy_plant should see the pending task and wait.
-    time_t start = time(NULL);
-    destroy_plant();
-    time_t end = time(NULL);
-
-    cleanup_task_memory(&t);
-
-    double elapsed = difftime(end, start);
-    if (elapsed >= 2.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        printf("(Elapsed: %.1fs) ", elapsed);
-        TEST_FAIL("destroy_plant exited too early! It abandoned the future task.");
-    }
-}
-
-/**
- * Scenario 3: The "Late Arriving" Worker
- * 
- * Condition: Task starts Now.
- *            Worker starts at Now+2.
- * 
- * Expected: Task sits in PENDING state until worker arrives.
- *           Total collection time approx 2 seconds.
- *           Verifies Alarm thread wakes up on worker->start.
- */
-int test_worker_starts_late() {
-    printf("Test 3: Worker starts late (Alarm on Worker Start)... ");
-    fflush(stdout);
-
-    int stations[] = {1};
-    init_plant(stations, 1, 1);
-
-    time_t now = time(NULL);
-
-    // Worker starts in 2 seconds
-    worker_t w = { .id = 1, .start = now + 2, .end = now + 10, .work = work_fn_simple };
-    add_worker(&w);
-
-    // Task wants to start NOW
-    task_t t = { .id = 300, .start = now, .capacity = 1 };
-    setup_task_memory(&t, 1);
-    add_task(&t);
-
-    time_t start = time(NULL);
-    if (collect_task(&t) != PLANTOK) TEST_FAIL("Collect failed");
-    time_t end = time(NULL);
-
-    cleanup_task_memory(&t);
-    destroy_plant();
-
-    double elapsed = difftime(end, start);
-    if (elapsed >= 2.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        TEST_FAIL("Task finished too early! Did not wait for worker start time?");
-    }
-}
-
-/**
- * Scenario 4: Multiple Future Tasks + Destroy
- * 
- * Condition: Task A starts T+1. Task B starts T+3.
- *            Call destroy_plant() at T+0.
- * 
- * Expected: Destroy waits ~3 seconds total. Both tasks execute.
- */
-int test_destroy_waits_multiple_future() {
-    printf("Test 4: Destroy waits for sequence of future tasks... ");
-    fflush(stdout);
-
-    int stations[] = {2};
-    init_plant(stations, 1, 2);
-
-    time_t now = time(NULL);
-    worker_t w1 = { .id = 1, .start = now, .end = now + 20, .work = work_fn_simple };
-    worker_t w2 = { .id = 2, .start = now, .end = now + 20, .work = work_fn_simple };
-    add_worker(&w1);
-    add_worker(&w2);
-
-    task_t t1 = { .id = 401, .start = now + 1, .capacity = 1 };
-    task_t t2 = { .id = 402, .start = now + 3, .capacity = 1 };
-    setup_task_memory(&t1, 1);
-    setup_task_memory(&t2, 1);
-
-    add_task(&t1);
-    add_task(&t2);
-
-    time_t start = time(NULL);
-    destroy_plant();
-    time_t end = time(NULL);
-
-    // Clean up memory manually since we didn't collect
-    cleanup_task_memory(&t1);
-    cleanup_task_memory(&t2);
-
-    double elapsed = difftime(end, start);
-    // Task 2 finishes at T+3 + epsilon.
-    if (elapsed >= 3.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        printf("(Elapsed: %.1fs) ", elapsed);
-        TEST_FAIL("destroy_plant didn't wait for the second future task.");
-    }
-}
-
-/**
- * Scenario 5: Shift Boundary Edge Case
- * 
- * Condition: Worker ends at T+2. Task starts at T+2.
- *            (Depending on implementation using > vs >=, this might succeed or fail).
- *            Standard logic: if start == end, strictly no time to work.
- *            But if start < end, 1 second of overlap is enough?
- * 
- * Let's test: Worker [Now, Now+2]. Task [Now+1].
- * Duration 1 second. Should Pass.
- */
-int test_worker_tight_schedule() {
-    printf("Test 5: Worker tight schedule (valid overlap)... ");
-    fflush(stdout);
-
-    int stations[] = {1};
-    init_plant(stations, 1, 1);
-
-    time_t now = time(NULL);
-
-    // Worker available for 2 seconds
-    worker_t w = { .id = 1, .start = now, .end = now + 2, .work = work_fn_simple };
-    add_worker(&w);
-
-    // Task starts at +1 second.
-    // Worker has 1 second remaining (from T+1 to T+2). Should be enough.
-    task_t t = { .id = 500, .start = now + 1, .capacity = 1 };
-    setup_task_memory(&t, 1);
-    add_task(&t);
-
-    int res = collect_task(&t);
-
-    cleanup_task_memory(&t);
-    destroy_plant();
-
-    if (res == PLANTOK) {
-        TEST_PASS();
-        return 0;
-    } else {
-        TEST_FAIL("Task skipped despite valid time window overlap");
-    }
-}
-
-/**
- * Scenario 6: Mixed Immediate and Future with Destroy
- * 
- * Condition: T1 (Immediate), T2 (Future).
- *            Destroy called immediately.
- *            T1 should finish fast, T2 waits.
- */
-int test_mixed_destroy() {
-    printf("Test 6: Mixed Immediate & Future with Destroy... ");
-    fflush(stdout);
-
-    int stations[] = {2};
-    init_plant(stations, 1, 2);
-    time_t now = time(NULL);
-
-    worker_t w1 = { .id = 1, .start = now, .end = now + 10, .work = work_fn_simple };
-    add_worker(&w1);
-
-    // T1: Immediate
-    task_t t1 = { .id = 601, .start = now, .capacity = 1 };
-    setup_task_memory(&t1, 1);
-    add_task(&t1);
-
-    // T2: Future (T+2)
-    task_t t2 = { .id = 602, .start = now + 2, .capacity = 1 };
-    setup_task_memory(&t2, 1);
-    add_task(&t2);
-
-    time_t start = time(NULL);
-    destroy_plant();
-    time_t end = time(NULL);
-
-    cleanup_task_memory(&t1);
-    cleanup_task_memory(&t2);
-
-    if (difftime(end, start) >= 2.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        TEST_FAIL("Destroy exited before future task T2 ran");
-    }
-}
-
-/**
- * Helper: Work function that sleeps for 1 second.
- */
-int work_sleep_1s(worker_t* w, task_t* t, int i) {
-    usleep(1000000); // 1 sekunda
-    return 1;
-}
-
-/**
- * Scenario 7: Massive Parallelism
- * 
- * Condition: 10 Workers. 1 Task with capacity 10.
- *            Station has capacity 10.
- *            Each 'slot' of the task takes 1 second.
- * 
- * Expected: All 10 threads launch approx at the same time.
- *           Total wall-clock time should be ~1s.
- *           If it takes ~10s, parallelism is broken.
- */
-int test_massive_parallelism() {
-    printf("Test 7: Massive Parallelism (10 threads at once)... ");
-    fflush(stdout);
-
-    // 1. Init: Stacja musi być duża, żeby przyjąć zadanie o capacity 10
-    int stations[] = {10}; 
-    if (init_plant(stations, 1, 10) != PLANTOK) TEST_FAIL("Init failed");
-
-    time_t now = time(NULL);
-
-    // 2. Dodajemy 10 pracowników
-    worker_t workers[10];
-    for(int i=0; i<10; ++i) {
-        workers[i].id = i;
-        workers[i].start = now;
-        workers[i].end = now + 20; // Długa szychta
-        workers[i].work = work_sleep_1s;
-        add_worker(&workers[i]);
-    }
-
-    // 3. Dodajemy 1 zadanie wymagające 10 pracowników naraz
-    task_t t = { .id = 777, .start = now, .capacity = 10 };
-    setup_task_memory(&t, 10);
-    add_task(&t);
-
-    // 4. Mierzymy czas wykonania collect_task
-    time_t start = time(NULL);
-    int res = collect_task(&t);
-    time_t end = time(NULL);
-
-    cleanup_task_memory(&t);
-    destroy_plant();
-
-    if (res != PLANTOK) {
-        TEST_FAIL("Collect task returned error");
-    }
-
-    double elapsed = difftime(end, start);
-    
-    // Debug info
-    // printf("(Elapsed: %.1fs) ", elapsed);
-
-    // Jeśli trwało mniej niż 3 sekundy (dajemy margines), to jest OK.
-    // Sekwencyjnie trwałoby 10s.
-    if (elapsed < 3.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        printf("[Time: %.1fs] ", elapsed);
-        TEST_FAIL("Execution was too slow! Looks sequential instead of parallel.");
-    }
-}
-
-static int n_workers = 20;
-static int n_stations = 10;
-int stations[10] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
-
-typedef struct {
-    pthread_barrier_t* barrier;
-    unsigned int seed;
-    int id;
-} thread_args_t;
-
-typedef struct {
-    int id;
-    time_t start_time;
-    int* status_ptr;
-    pthread_barrier_t* barrier;
-} and_and_collect_t;
-
-typedef struct {
-    task_t* t;
-    worker_t* w;
-    pthread_barrier_t* barier;
-    int* status_ptr;
-    unsigned int seed;
-} worker_and_task_t;
-
-void* client_thread_func(void* arg) {
-    worker_and_task_t* info = (worker_and_task_t*)arg;
-    
-    setup_task_memory(info->t, 1); 
-    int res;
-
-    pthread_barrier_wait(info->barier);
-
-    add_worker(info->w);
-    add_task(info->t);
-    res = collect_task(info->t);
-
-    if (res != PLANTOK) *(info->status_ptr) = 0; 
-    else *(info->status_ptr) = 1; 
-
-    return NULL;
-}
-
-int test_concurrent_clients() {
-    printf("Test 8: Concurrent Clients ");
-    fflush(stdout);
-
-    pthread_t clients[10];
-    worker_and_task_t args[10];
-    int statuses[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    task_t tasks[10];
-    worker_t workers[10];
-
-    if (init_plant(stations, 10, 10) != PLANTOK) TEST_FAIL("Init failed");
-
-    time_t now = time(NULL);
-
-    pthread_barrier_t start_barrier;
-    pthread_barrier_init(&start_barrier, NULL, 11);
-
-    for(int i=0; i<10; i++) {
-        tasks[i] = (task_t){.id = i, .start = now, .capacity = 1};
-        workers[i] = (worker_t){.id = i + 10, .start = now, .end = now + 10, .work = work_sleep_1s};
-        
-        args[i] = (worker_and_task_t){
-            .w = &workers[i], 
-            .barier = &start_barrier,
-            .status_ptr = &statuses[i], 
-            .t = &tasks[i]
-        };
-        
-        if (pthread_create(&clients[i], NULL, client_thread_func, &args[i]) != 0) {
-            TEST_FAIL("Failed to create client thread");
-        }
-    }
-
-    pthread_barrier_wait(&start_barrier);
-    time_t start_time = time(NULL);
-    
-    for(int i=0; i<10; i++) {
-        pthread_join(clients[i], NULL);
-    }
-    time_t end_time = time(NULL);
-
-    destroy_plant();
-    pthread_barrier_destroy(&start_barrier);
-
-    double elapsed = difftime(end_time, start_time);
-
-    for(int i=0; i<10; i++) {
-        if (statuses[i] == 0) TEST_FAIL("Client failed to collect task");
-    }
-
-    for (int i = 0; i < 10; i++) {
-        cleanup_task_memory(&tasks[i]);
-    }
-
-    if (elapsed < 3.0) {
-        TEST_PASS();
-        return 0;
-    } else {
-        printf("[Time: %.1fs] ", elapsed);
-        TEST_FAIL("Too slow! Parallelism broken.");
-    }
-}
-/// a czekamy na task kotry sie nigdy nie wydarzy 
-void* stress_thread_func(void* arg) {
-    worker_and_task_t* info = (worker_and_task_t*)arg;
-    
-    setup_task_memory(info->t, 1);
-    
-    pthread_barrier_wait(info->barier);
-
-    int op = rand_r(&info->seed) % 5;
-    switch(op) {
-        case 0: 
-        case 1: { 
-            if (add_task(info->t) == PLANTOK) {
-                collect_task(info->t);
-            }
-            break;
-        }
-        case 2: {
-            init_plant(stations, n_stations, n_workers);
-            break;
-        }
-        case 3: {
-            destroy_plant();
-            break;
-        }
-        case 4: { 
-            add_worker(info->w);
-            break;
-        }
-    }
-
-    *(info->status_ptr) = 1; 
-    return NULL;
-}
-
-int test_stress_mixed_ops(unsigned int main_seed) {
-    printf("Test 10: Stress Mixed Ops (20 threads, seed: %u) ", main_seed);
-    fflush(stdout);
-
-    const int N = 20;
-    pthread_t threads[N];
-    worker_and_task_t args[N];
-    int statuses[N];
-    task_t tasks[N];
-    worker_t workers[N];
-
-    time_t now = time(NULL); 
-    
-    pthread_barrier_t barrier;
-    pthread_barrier_init(&barrier, NULL, N + 1);
-
-    destroy_plant();
-
-    for(int i = 0; i < N; i++) {
-        tasks[i] = (task_t){.id = i, .start = now, .capacity = 1};
-        workers[i] = (worker_t){.id = i + 100, .start = now, .end = now + 10, .work = work_sleep_1s};
-        statuses[i] = 0;
-
-        args[i] = (worker_and_task_t){
-            .t = &tasks[i],
-            .w = &workers[i],
-            .barier = &barrier,
-            .status_ptr = &statuses[i],
-            // Tu jest klucz: seed zależy TYLKO od argumentu funkcji i indeksu pętli
-            .seed = main_seed + i 
-        };
-        
-        if (pthread_create(&threads[i], NULL, stress_thread_func, &args[i]) != 0) {
-            TEST_FAIL("Failed to create thread");
-        }
-    }
-
-    pthread_barrier_wait(&barrier);
-    
-    for(int i = 0; i < N; i++) {
-        pthread_join(threads[i], NULL);
-    }
-
-    pthread_barrier_destroy(&barrier);
-    destroy_plant();
-
-    for(int i = 0; i < N; i++) {
-        cleanup_task_memory(&tasks[i]);
-    }
-
-    TEST_PASS();
-    return 0;
-}
-
-
-
-/* -------------------------------------------------------------------------- */
-/*                                    Main                                    */
-/* -------------------------------------------------------------------------- */
-
-int main() {
-    printf("==========================================\n");
-    printf("     Advanced Plant Logic Tests           \n");
-    printf("==========================================\n\n");
-
-    int fail_count = 0;
-    if (test_worker_ends_before_task_starts() != 0) fail_count++;
-    if (test_destroy_waits_for_future() != 0) fail_count++;
-    if (test_worker_starts_late() != 0) fail_count++;
-    if (test_destroy_waits_multiple_future() != 0) fail_count++;
-    if (test_worker_tight_schedule() != 0) fail_count++;
-    if (test_mixed_destroy() != 0) fail_count++;
-    if (test_massive_parallelism() != 0) fail_count++;
-    
-    if (test_concurrent_clients() != 0) fail_count++;
-    printf("RANDOMIZED TESTS, IF THERE WAS ERROR ON TEST I, \n YOU CAN JUST CALL `test_stress_mixed_ops(i)` AND ANALYZE WITH VALGRIND\n ");
-    printf("FOR EXAMPLE:  valgrind --leak-check=full --show-leak-kinds=all --track-origins=yes --trace-children=yes --fair-sched=yes --log-file=valgrind-out.txt ./demo");
-    
-    printf("\n==========================================\n");
-    if (fail_count == 0) {
-        printf(GREEN "ALL ADVANCED TESTS PASSED.\n" RESET);
-        return 0;
-    } else {
-        printf(RED "%d TESTS FAILED.\n" RESET, fail_count);
-        return 1;
-    }
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <assert.h>
+#include <math.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+// Adjust paths to match your project structure
+#include "../common/err.h"
+#include "../common/plant.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                Test Helpers                                */
+/* -------------------------------------------------------------------------- */
+
+#define GREEN "\033[0;32m"
+#define RED   "\033[0;31m"
+#define RESET "\033[0m"
+
+#define TEST_PASS() printf(GREEN "PASS\n" RESET)
+#define TEST_FAIL(msg) do { printf(RED "FAIL: %s (Line %d)\n" RESET, msg, __LINE__); return -1; } while(0)
+
+// Helper to allocate result memory (int*)
+void setup_task_memory(task_t* t, int capacity) {
+    t->results = (int*)malloc(sizeof(int) * capacity);
+}
+
+void cleanup_task_memory(task_t* t) {
+    if (t->results) free(t->results);
+}
+
+// Simple work function: returns 1
+int work_fn_simple(worker_t* worker, task_t* task, int aux) {
+    usleep(10000); // 10ms work
+    return 1;
+}
+
+// Work function without any delay.
+int work_fn_instant(worker_t* worker, task_t* task, int aux) {
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Scenarios                                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Scenario 1: The "Zombie" Worker (Your specific example)
+ * 
+ * Condition: Worker is available [Now, Now+1].
+ *            Task starts at [Now+3].
+ * 
+ * Expected: Task cannot be started because by the time it reaches start time,
+ *           the worker has gone home.
+ *           collect_task should return ERROR (task skipped).
+ */
+int test_worker_ends_before_task_starts() {
+    printf("Test 1: Worker ends shift before task starts... ");
+    fflush(stdout);
+
+    int stations[] = {1};
+    if (init_plant(stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+
+    // Worker works for only 1 second
+    worker_t w = { .id = 1, .start = now, .end = now + 1, .work = work_fn_simple };
+    add_worker(&w);
+
+    // Task starts in 3 seconds
+    task_t t = { .id = 100, .start = now + 3, .capacity = 1 };
+    setup_task_memory(&t, 1);
+    add_task(&t);
+
+    // Should return ERROR because task is skipped (impossible to schedule)
+    int res = collect_task(&t);
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    if (res == ERROR) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task should have been skipped (returned ERROR), but returned PLANTOK");
+    }
+}
+
+/**
+ * Scenario 2: The "Patient" Destroyer
+ * 
+ * Condition: Task starts in the future (T+2).
+ *            We call destroy_plant() immediately at T+0.
+ * 
+ * Expected: destroy_plant() MUST NOT exit immediately. 
+ *           It must wait for the task to become active, execute, and finish.
+ *           Execution time should be approx 2 seconds.
+ */
+int test_destroy_waits_for_future() {
+    printf("Test 2: Destroy waits for future task... ");
+    fflush(stdout);
+
+    int stations[] = {1};
+    init_plant(stations, 1, 1);
+
+    time_t now = time(NULL);
+
+    // Worker is available for a long time
+    worker_t w = { .id = 1, .start = now, .end = now + 10, .work = work_fn_simple };
+    add_worker(&w);
+
+    // Task starts in 2 seconds
+    task_t t = { .id = 200, .start = now + 2, .capacity = 1 };
+    setup_task_memory(&t, 1);
+    add_task(&t);
+    // We do NOT call collect_task. We go straight to destroy.
+    // destroy_plant should see the pending task and wait.
+    time_t start = time(NULL);
+    destroy_plant();
+    time_t end = time(NULL);
+
+    cleanup_task_memory(&t);
+
+    double elapsed = difftime(end, start);
+    if (elapsed >= 2.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("(Elapsed: %.1fs) ", elapsed);
+        TEST_FAIL("destroy_plant exited too early! It abandoned the future task.");
+    }
+}
+
+/**
+ * Scenario 3: The "Late Arriving" Worker
+ * 
+ * Condition: Task starts Now.
+ *            Worker starts at Now+2.
+ * 
+ * Expected: Task sits in PENDING state until worker arrives.
+ *           Total collection time approx 2 seconds.
+ *           Verifies Alarm thread wakes up on worker->start.
+ */
+int test_worker_starts_late() {
+    printf("Test 3: Worker starts late (Alarm on Worker Start)... ");
+    fflush(stdout);
+
+    int stations[] = {1};
+    init_plant(stations, 1, 1);
+
+    time_t now = time(NULL);
+
+    // Worker starts in 2 seconds
+    worker_t w = { .id = 1, .start = now + 2, .end = now + 10, .work = work_fn_simple };
+    add_worker(&w);
+
+    // Task wants to start NOW
+    task_t t = { .id = 300, .start = now, .capacity = 1 };
+    setup_task_memory(&t, 1);
+    add_task(&t);
+
+    time_t start = time(NULL);
+    if (collect_task(&t) != PLANTOK) TEST_FAIL("Collect failed");
+    time_t end = time(NULL);
+
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    double elapsed = difftime(end, start);
+    if (elapsed >= 2.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task finished too early! Did not wait for worker start time?");
+    }
+}
+
+/**
+ * Scenario 4: Multiple Future Tasks + Destroy
+ * 
+ * Condition: Task A starts T+1. Task B starts T+3.
+ *            Call destroy_plant() at T+0.
+ * 
+ * Expected: Destroy waits ~3 seconds total. Both tasks execute.
+ */
+int test_destroy_waits_multiple_future() {
+    printf("Test 4: Destroy waits for sequence of future tasks... ");
+    fflush(stdout);
+
+    int stations[] = {2};
+    init_plant(stations, 1, 2);
+
+    time_t now = time(NULL);
+    worker_t w1 = { .id = 1, .start = now, .end = now + 20, .work = work_fn_simple };
+    worker_t w2 = { .id = 2, .start = now, .end = now + 20, .work = work_fn_simple };
+    add_worker(&w1);
+    add_worker(&w2);
+
+    task_t t1 = { .id = 401, .start = now + 1, .capacity = 1 };
+    task_t t2 = { .id = 402, .start = now + 3, .capacity = 1 };
+    setup_task_memory(&t1, 1);
+    setup_task_memory(&t2, 1);
+
+    add_task(&t1);
+    add_task(&t2);
+
+    time_t start = time(NULL);
+    destroy_plant();
+    time_t end = time(NULL);
+
+    // Clean up memory manually since we didn't collect
+    cleanup_task_memory(&t1);
+    cleanup_task_memory(&t2);
+
+    double elapsed = difftime(end, start);
+    // Task 2 finishes at T+3 + epsilon.
+    if (elapsed >= 3.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("(Elapsed: %.1fs) ", elapsed);
+        TEST_FAIL("destroy_plant didn't wait for the second future task.");
+    }
+}
+
+/**
+ * Scenario 5: Shift Boundary Edge Case
+ * 
+ * Condition: Worker ends at T+2. Task starts at T+2.
+ *            (Depending on implementation using > vs >=, this might succeed or fail).
+ *            Standard logic: if start == end, strictly no time to work.
+ *            But if start < end, 1 second of overlap is enough?
+ * 
+ * Let's test: Worker [Now, Now+2]. Task [Now+1].
+ * Duration 1 second. Should Pass.
+ */
+int test_worker_tight_schedule() {
+    printf("Test 5: Worker tight schedule (valid overlap)... ");
+    fflush(stdout);
+
+    int stations[] = {1};
+    init_plant(stations, 1, 1);
+
+    time_t now = time(NULL);
+
+    // Worker available for 2 seconds
+    worker_t w = { .id = 1, .start = now, .end = now + 2, .work = work_fn_simple };
+    add_worker(&w);
+
+    // Task starts at +1 second.
+    // Worker has 1 second remaining (from T+1 to T+2). Should be enough.
+    task_t t = { .id = 500, .start = now + 1, .capacity = 1 };
+    setup_task_memory(&t, 1);
+    add_task(&t);
+
+    int res = collect_task(&t);
+
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    if (res == PLANTOK) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task skipped despite valid time window overlap");
+    }
+}
+
+/**
+ * Scenario 6: Mixed Immediate and Future with Destroy
+ * 
+ * Condition: T1 (Immediate), T2 (Future).
+ *            Destroy called immediately.
+ *            T1 should finish fast, T2 waits.
+ */
+int test_mixed_destroy() {
+    printf("Test 6: Mixed Immediate & Future with Destroy... ");
+    fflush(stdout);
+
+    int stations[] = {2};
+    init_plant(stations, 1, 2);
+    time_t now = time(NULL);
+
+    worker_t w1 = { .id = 1, .start = now, .end = now + 10, .work = work_fn_simple };
+    add_worker(&w1);
+
+    // T1: Immediate
+    task_t t1 = { .id = 601, .start = now, .capacity = 1 };
+    setup_task_memory(&t1, 1);
+    add_task(&t1);
+
+    // T2: Future (T+2)
+    task_t t2 = { .id = 602, .start = now + 2, .capacity = 1 };
+    setup_task_memory(&t2, 1);
+    add_task(&t2);
+
+    time_t start = time(NULL);
+    destroy_plant();
+    time_t end = time(NULL);
+
+    cleanup_task_memory(&t1);
+    cleanup_task_memory(&t2);
+
+    if (difftime(end, start) >= 2.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Destroy exited before future task T2 ran");
+    }
+}
+
+/**
+ * Helper: Work function that sleeps for 1 second.
+ */
+int work_sleep_1s(worker_t* w, task_t* t, int i) {
+    usleep(1000000); // 1 sekunda
+    return 1;
+}
+
+/**
+ * Scenario 7: Massive Parallelism
+ * 
+ * Condition: 10 Workers. 1 Task with capacity 10.
+ *            Station has capacity 10.
+ *            Each 'slot' of the task takes 1 second.
+ * 
+ * Expected: All 10 threads launch approx at the same time.
+ *           Total wall-clock time should be ~1s.
+ *           If it takes ~10s, parallelism is broken.
+ */
+int test_massive_parallelism() {
+    printf("Test 7: Massive Parallelism (10 threads at once)... ");
+    fflush(stdout);
+
+    // 1. Init: Stacja musi być duża, żeby przyjąć zadanie o capacity 10
+    int stations[] = {10}; 
+    if (init_plant(stations, 1, 10) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+
+    // 2. Dodajemy 10 pracowników
+    worker_t workers[10];
+    for(int i=0; i<10; ++i) {
+        workers[i].id = i;
+        workers[i].start = now;
+        workers[i].end = now + 20; // Długa szychta
+        workers[i].work = work_sleep_1s;
+        add_worker(&workers[i]);
+    }
+
+    // 3. Dodajemy 1 zadanie wymagające 10 pracowników naraz
+    task_t t = { .id = 777, .start = now, .capacity = 10 };
+    setup_task_memory(&t, 10);
+    add_task(&t);
+
+    // 4. Mierzymy czas wykonania collect_task
+    time_t start = time(NULL);
+    int res = collect_task(&t);
+    time_t end = time(NULL);
+
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    if (res != PLANTOK) {
+        TEST_FAIL("Collect task returned error");
+    }
+
+    double elapsed = difftime(end, start);
+    
+    // Debug info
+    // printf("(Elapsed: %.1fs) ", elapsed);
+
+    // Jeśli trwało mniej niż 3 sekundy (dajemy margines), to jest OK.
+    // Sekwencyjnie trwałoby 10s.
+    if (elapsed < 3.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("[Time: %.1fs] ", elapsed);
+        TEST_FAIL("Execution was too slow! Looks sequential instead of parallel.");
+    }
+}
+
+static int n_workers = 20;
+static int n_stations = 10;
+int stations[10] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+
+typedef struct {
+    pthread_barrier_t* barrier;
+    unsigned int seed;
+    int id;
+} thread_args_t;
+
+typedef struct {
+    int id;
+    time_t start_time;
+    int* status_ptr;
+    pthread_barrier_t* barrier;
+} and_and_collect_t;
+
+typedef struct {
+    task_t* t;
+    worker_t* w;
+    pthread_barrier_t* barier;
+    int* status_ptr;
+    unsigned int seed;
+} worker_and_task_t;
+
+void* client_thread_func(void* arg) {
+    worker_and_task_t* info = (worker_and_task_t*)arg;
+    
+    setup_task_memory(info->t, 1); 
+    int res;
+
+    pthread_barrier_wait(info->barier);
+
+    add_worker(info->w);
+    add_task(info->t);
+    res = collect_task(info->t);
+
+    if (res != PLANTOK) *(info->status_ptr) = 0; 
+    else *(info->status_ptr) = 1; 
+
+    return NULL;
+}
+
+int test_concurrent_clients() {
+    printf("Test 8: Concurrent Clients ");
+    fflush(stdout);
+
+    pthread_t clients[10];
+    worker_and_task_t args[10];
+    int statuses[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    task_t tasks[10];
+    worker_t workers[10];
+
+    if (init_plant(stations, 10, 10) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+
+    pthread_barrier_t start_barrier;
+    pthread_barrier_init(&start_barrier, NULL, 11);
+
+    for(int i=0; i<10; i++) {
+        tasks[i] = (task_t){.id = i, .start = now, .capacity = 1};
+        workers[i] = (worker_t){.id = i + 10, .start = now, .end = now + 10, .work = work_sleep_1s};
+        
+        args[i] = (worker_and_task_t){
+            .w = &workers[i], 
+            .barier = &start_barrier,
+            .status_ptr = &statuses[i], 
+            .t = &tasks[i]
+        };
+        
+        if (pthread_create(&clients[i], NULL, client_thread_func, &args[i]) != 0) {
+            TEST_FAIL("Failed to create client thread");
+        }
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    time_t start_time = time(NULL);
+    
+    for(int i=0; i<10; i++) {
+        pthread_join(clients[i], NULL);
+    }
+    time_t end_time = time(NULL);
+
+    destroy_plant();
+    pthread_barrier_destroy(&start_barrier);
+
+    double elapsed = difftime(end_time, start_time);
+
+    for(int i=0; i<10; i++) {
+        if (statuses[i] == 0) TEST_FAIL("Client failed to collect task");
+    }
+
+    for (int i = 0; i < 10; i++) {
+        cleanup_task_memory(&tasks[i]);
+    }
+
+    if (elapsed < 3.0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("[Time: %.1fs] ", elapsed);
+        TEST_FAIL("Too slow! Parallelism broken.");
+    }
+}
+/// a czekamy na task kotry sie nigdy nie wydarzy 
+void* stress_thread_func(void* arg) {
+    worker_and_task_t* info = (worker_and_task_t*)arg;
+    
+    setup_task_memory(info->t, 1);
+    
+    pthread_barrier_wait(info->barier);
+
+    int op = rand_r(&info->seed) % 5;
+    switch(op) {
+        case 0: 
+        case 1: { 
+            if (add_task(info->t) == PLANTOK) {
+                collect_task(info->t);
+            }
+            break;
+        }
+        case 2: {
+            init_plant(stations, n_stations, n_workers);
+            break;
+        }
+        case 3: {
+            destroy_plant();
+            break;
+        }
+        case 4: { 
+            add_worker(info->w);
+            break;
+        }
+    }
+
+    *(info->status_ptr) = 1; 
+    return NULL;
+}
+
+int test_stress_mixed_ops(unsigned int main_seed) {
+    printf("Test 10: Stress Mixed Ops (20 threads, seed: %u) ", main_seed);
+    fflush(stdout);
+
+    const int N = 20;
+    pthread_t threads[N];
+    worker_and_task_t args[N];
+    int statuses[N];
+    task_t tasks[N];
+    worker_t workers[N];
+
+    time_t now = time(NULL); 
+    
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, N + 1);
+
+    destroy_plant();
+
+    for(int i = 0; i < N; i++) {
+        tasks[i] = (task_t){.id = i, .start = now, .capacity = 1};
+        workers[i] = (worker_t){.id = i + 100, .start = now, .end = now + 10, .work = work_sleep_1s};
+        statuses[i] = 0;
+
+        args[i] = (worker_and_task_t){
+            .t = &tasks[i],
+            .w = &workers[i],
+            .barier = &barrier,
+            .status_ptr = &statuses[i],
+            // Tu jest klucz: seed zależy TYLKO od argumentu funkcji i indeksu pętli
+            .seed = main_seed + i 
+        };
+        
+        if (pthread_create(&threads[i], NULL, stress_thread_func, &args[i]) != 0) {
+            TEST_FAIL("Failed to create thread");
+        }
+    }
+
+    pthread_barrier_wait(&barrier);
+    
+    for(int i = 0; i < N; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    destroy_plant();
+
+    for(int i = 0; i < N; i++) {
+        cleanup_task_memory(&tasks[i]);
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+
+
+/**
+ * Scenario 9: Best Fit Station
+ *
+ * Condition: Stations of capacity 3 and 1, 4 workers.
+ *            Task A needs 1 worker, task B needs 3, both start now.
+ *
+ * Expected: A lands on the small station, so B still fits on the big one
+ *           and both run in parallel (~1s instead of ~2s).
+ */
+int test_best_fit_station() {
+    printf("Test 9: Best fit station keeps big station free... ");
+    fflush(stdout);
+
+    int best_fit_stations[] = {3, 1};
+    if (init_plant(best_fit_stations, 2, 4) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_sleep_1s };
+        add_worker(&workers[i]);
+    }
+
+    task_t a = { .id = 901, .start = now, .capacity = 1 };
+    task_t b = { .id = 902, .start = now, .capacity = 3 };
+    setup_task_memory(&a, 1);
+    setup_task_memory(&b, 3);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    add_task(&a);
+    add_task(&b);
+    int res_a = collect_task(&a);
+    int res_b = collect_task(&b);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    cleanup_task_memory(&a);
+    cleanup_task_memory(&b);
+    destroy_plant();
+
+    if (res_a != PLANTOK || res_b != PLANTOK) TEST_FAIL("Collect failed");
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (elapsed < 1.8) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("[Time: %.1fs] ", elapsed);
+        TEST_FAIL("Small task took the big station.");
+    }
+}
+
+/**
+ * Scenario 11: Collected Tasks Are Retired
+ *
+ * Condition: The same task id is submitted and collected many times in a row.
+ *
+ * Expected: Every round succeeds, because a collected task is forgotten
+ *           by the plant, and collecting it once more returns ERROR.
+ */
+int test_collected_tasks_retired() {
+    printf("Test 11: Collected tasks are retired and ids reused... ");
+    fflush(stdout);
+
+    int retire_stations[] = {1};
+    if (init_plant(retire_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t w = { .id = 1, .start = now, .end = now + 20, .work = work_fn_instant };
+    add_worker(&w);
+
+    task_t t = { .id = 1100, .start = now, .capacity = 1 };
+    setup_task_memory(&t, 1);
+
+    for (int round = 0; round < 100; round++) {
+        if (add_task(&t) != PLANTOK) TEST_FAIL("Add failed");
+        if (collect_task(&t) != PLANTOK) TEST_FAIL("Collect failed");
+    }
+    int again = collect_task(&t);
+
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    if (again == ERROR) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task was still known after being collected");
+    }
+}
+
+/**
+ * Scenario 12: Sub-second Start
+ *
+ * Condition: Worker on shift for 2 seconds, task starts 300ms from now,
+ *            both given in plant clock nanoseconds.
+ *
+ * Expected: Task is collected after ~300ms, not rounded to whole seconds.
+ */
+int test_sub_second_start() {
+    printf("Test 12: Sub-second task start... ");
+    fflush(stdout);
+
+    int ns_stations[] = {1};
+    if (init_plant(ns_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    int64_t now = plant_now_ns();
+    worker_t w = { .id = 1, .work = work_fn_instant };
+    worker_attr_t w_attr = { .start_ns = now, .end_ns = now + 2000000000LL };
+    add_worker_ex(&w, &w_attr);
+
+    task_t t = { .id = 1200, .capacity = 1 };
+    task_attr_t t_attr = { .start_ns = now + 300000000LL };
+    setup_task_memory(&t, 1);
+    add_task_ex(&t, &t_attr);
+
+    int res = collect_task(&t);
+    double elapsed = (plant_now_ns() - now) / 1e9;
+
+    cleanup_task_memory(&t);
+    destroy_plant();
+
+    if (res != PLANTOK) TEST_FAIL("Collect failed");
+    if (elapsed >= 0.3 && elapsed < 0.8) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("[Time: %.3fs] ", elapsed);
+        TEST_FAIL("Task didn't start at its sub-second start time.");
+    }
+}
+
+/**
+ * Scenario 13: Pool Threads
+ *
+ * Condition: 2 pool threads serve 6 workers, 3 tasks need 2 workers each.
+ *
+ * Expected: Every task is performed by the shared threads and every
+ *           result slot gets written.
+ */
+int test_pool_threads() {
+    printf("Test 13: Pool threads multiplex workers... ");
+    fflush(stdout);
+
+    int pool_stations[] = {2, 2, 2};
+    plant_options_t options = { .pool_threads = 2 };
+    if (init_plant_ex(pool_stations, 3, 6, &options) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[6];
+    for (int i = 0; i < 6; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_simple };
+        add_worker(&workers[i]);
+    }
+
+    task_t tasks[3];
+    for (int i = 0; i < 3; i++) {
+        tasks[i] = (task_t){ .id = 1300 + i, .start = now, .capacity = 2 };
+        setup_task_memory(&tasks[i], 2);
+        tasks[i].results[0] = tasks[i].results[1] = 0;
+        add_task(&tasks[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < 3; i++) {
+        if (collect_task(&tasks[i]) != PLANTOK) ok = 0;
+        if (tasks[i].results[0] != 1 || tasks[i].results[1] != 1) ok = 0;
+        cleanup_task_memory(&tasks[i]);
+    }
+    destroy_plant();
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Pool threads didn't perform every task");
+    }
+}
+
+/**
+ * Scenario 14: Submissions From Many Threads
+ *
+ * Condition: 4 client threads add tasks and collect each one right away,
+ *            so collect_task often runs before the manager saw the task.
+ *
+ * Expected: Every task is found by its collector and performed.
+ */
+#define SUBMIT_CLIENTS 4
+#define SUBMIT_TASKS 50
+
+void* submit_client_func(void* arg) {
+    int client = *(int*)arg;
+    int failed = 0;
+    for (int i = 0; i < SUBMIT_TASKS; i++) {
+        task_t t = { .id = 1400 + client * SUBMIT_TASKS + i, .start = time(NULL), .capacity = 1 };
+        setup_task_memory(&t, 1);
+        t.results[0] = 0;
+        if (add_task(&t) != PLANTOK || collect_task(&t) != PLANTOK || t.results[0] != 1)
+            failed++;
+        cleanup_task_memory(&t);
+    }
+    *(int*)arg = failed;
+    return NULL;
+}
+
+int test_concurrent_submissions() {
+    printf("Test 14: Submissions from many threads... ");
+    fflush(stdout);
+
+    int submit_stations[] = {1, 1};
+    plant_options_t options = { .pool_threads = 2 };
+    if (init_plant_ex(submit_stations, 2, 2, &options) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_instant };
+        add_worker(&workers[i]);
+    }
+
+    pthread_t clients[SUBMIT_CLIENTS];
+    int args[SUBMIT_CLIENTS];
+    for (int i = 0; i < SUBMIT_CLIENTS; i++) {
+        args[i] = i;
+        if (pthread_create(&clients[i], NULL, submit_client_func, &args[i]) != 0)
+            TEST_FAIL("pthread_create failed");
+    }
+
+    int failed = 0;
+    for (int i = 0; i < SUBMIT_CLIENTS; i++) {
+        pthread_join(clients[i], NULL);
+        failed += args[i];
+    }
+    destroy_plant();
+
+    if (failed == 0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        printf("(%d failed) ", failed);
+        TEST_FAIL("Submitted tasks were lost");
+    }
+}
+
+/**
+ * Scenario 15: Batch Calls
+ *
+ * Condition: 2 workers are added in one batch (a third batch doesn't fit),
+ *            then 4 tasks in one batch, one of them starting 2s later.
+ *
+ * Expected: Waiting for any task returns before the late one is done and
+ *           leaves it pending, waiting for all of the rest collects it.
+ */
+int test_batch_calls() {
+    printf("Test 15: Batch add and collect... ");
+    fflush(stdout);
+
+    int batch_stations[] = {1, 1};
+    if (init_plant(batch_stations, 2, 2) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[3];
+    worker_t* worker_ptrs[3];
+    for (int i = 0; i < 3; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_instant };
+        worker_ptrs[i] = &workers[i];
+    }
+    if (add_workers(worker_ptrs, 2) != PLANTOK) TEST_FAIL("Batch of workers failed");
+    if (add_workers(worker_ptrs + 2, 1) != ERROR) TEST_FAIL("Batch over n_workers accepted");
+
+    task_t tasks[4];
+    task_t* task_ptrs[4];
+    for (int i = 0; i < 4; i++) {
+        tasks[i] = (task_t){ .id = 1500 + i, .start = i == 3 ? now + 2 : now, .capacity = 1 };
+        setup_task_memory(&tasks[i], 1);
+        task_ptrs[i] = &tasks[i];
+    }
+    if (add_tasks(task_ptrs, 4) != PLANTOK) TEST_FAIL("Batch of tasks failed");
+
+    int status[4];
+    int ok = collect_tasks(task_ptrs + 2, 2, PLANT_WAIT_ANY, status) == PLANTOK &&
+             status[0] == PLANTOK && status[1] == PLANT_PENDING;
+    task_t* rest[] = { &tasks[0], &tasks[1], &tasks[3] };
+    ok = ok && collect_tasks(rest, 3, PLANT_WAIT_ALL, status) == PLANTOK &&
+         status[0] == PLANTOK && status[1] == PLANTOK && status[2] == PLANTOK;
+
+    for (int i = 0; i < 4; i++)
+        cleanup_task_memory(&tasks[i]);
+    destroy_plant();
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Batch collect returned wrong statuses");
+    }
+}
+
+/**
+ * Scenario 16: Asynchronous Collect
+ *
+ * Condition: One task is collected with a callback, two more are collected
+ *            through the eventfd and the drain call, one of them can't fit.
+ *
+ * Expected: The callback reports success, the eventfd becomes readable and
+ *           the drain returns both ids with their statuses.
+ */
+atomic_int async_callback_status = 1;
+
+void async_callback(task_t* t, int status, void* arg) {
+    atomic_store(&async_callback_status, status);
+}
+
+int test_async_collect() {
+    printf("Test 16: Asynchronous collect... ");
+    fflush(stdout);
+
+    int async_stations[] = {1};
+    if (init_plant(async_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t w = { .id = 1, .start = now, .end = now + 20, .work = work_fn_simple };
+    add_worker(&w);
+
+    task_t tasks[3];
+    for (int i = 0; i < 3; i++) {
+        tasks[i] = (task_t){ .id = 1600 + i, .start = now, .capacity = i == 2 ? 2 : 1 };
+        setup_task_memory(&tasks[i], tasks[i].capacity);
+        add_task(&tasks[i]);
+    }
+
+    int ok = collect_task_async(&tasks[0], async_callback, NULL) == PLANTOK &&
+             collect_task_async(&tasks[1], NULL, NULL) == PLANTOK &&
+             collect_task_async(&tasks[2], NULL, NULL) == PLANTOK &&
+             collect_task_async(&tasks[1], NULL, NULL) == ERROR;
+
+    int ids[3];
+    int status[3];
+    int drained = 0;
+    struct pollfd pfd = { .fd = plant_completion_fd(NULL), .events = POLLIN };
+    while (ok && drained < 2) {
+        if (poll(&pfd, 1, 5000) != 1) {
+            ok = 0;
+            break;
+        }
+        int n = plant_drain_completed(NULL, ids + drained, status + drained, 3 - drained);
+        if (n < 0) ok = 0;
+        else drained += n;
+    }
+    destroy_plant();
+
+    for (int i = 0; i < 3; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    for (int i = 0; ok && i < drained; i++) {
+        int expected = ids[i] == 1601 ? PLANTOK : ERROR;
+        if ((ids[i] != 1601 && ids[i] != 1602) || status[i] != expected) ok = 0;
+    }
+
+    if (ok && drained == 2 && async_callback_status == PLANTOK) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Asynchronous collectors didn't get the right answers");
+    }
+}
+
+/**
+ * Scenario 17: Independent Plants
+ *
+ * Condition: Two plants are created while the default one runs too. Each
+ *            gets its own worker and tasks with the same ids, only the
+ *            second one has a station big enough for a task of capacity 2.
+ *
+ * Expected: Every plant answers for its own tasks only, the big task fails
+ *           in the first plant and succeeds in the second.
+ */
+int test_independent_plants() {
+    printf("Test 17: Independent plants... ");
+    fflush(stdout);
+
+    int small_stations[] = {1};
+    int big_stations[] = {2};
+    plant_t* plants[2];
+    plants[0] = plant_create(small_stations, 1, 2, NULL);
+    plants[1] = plant_create(big_stations, 1, 2, NULL);
+    if (!plants[0] || !plants[1]) TEST_FAIL("Create failed");
+    if (init_plant(small_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[2][2];
+    task_t tasks[2][2];
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; i < 2; i++) {
+            workers[p][i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_instant };
+            plant_add_worker(plants[p], &workers[p][i], NULL);
+            tasks[p][i] = (task_t){ .id = 1700 + i, .start = now, .capacity = i + 1 };
+            setup_task_memory(&tasks[p][i], i + 1);
+            plant_add_task(plants[p], &tasks[p][i], NULL);
+        }
+    }
+
+    int ok = plant_collect_task(plants[0], &tasks[0][0]) == PLANTOK &&
+             plant_collect_task(plants[0], &tasks[0][1]) == ERROR &&
+             plant_collect_task(plants[1], &tasks[1][0]) == PLANTOK &&
+             plant_collect_task(plants[1], &tasks[1][1]) == PLANTOK;
+    /* Neither task reached the default plant. */
+    ok = ok && collect_task(&tasks[1][0]) == ERROR;
+
+    ok = plant_destroy(plants[0]) == PLANTOK && ok;
+    ok = plant_destroy(plants[1]) == PLANTOK && ok;
+    ok = destroy_plant() == PLANTOK && ok;
+
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; i < 2; i++)
+            cleanup_task_memory(&tasks[p][i]);
+    }
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Plants mixed up their tasks");
+    }
+}
+
+/**
+ * Scenario 18: Pinned Stations and Workers
+ *
+ * Condition: A plant whose only station is pinned to one CPU gets an
+ *            unpinned worker, another plant gets a worker pinned to that CPU.
+ *            Their work reports the CPUs it may run on.
+ *
+ * Expected: Both tasks ran on exactly that CPU, an out of range CPU is
+ *           refused and plant_alloc_on_cpus gives zeroed memory.
+ */
+int pinned_cpu;
+
+int work_fn_report_cpus(worker_t* worker, task_t* task, int aux) {
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return 0;
+    return CPU_COUNT(&set) == 1 && CPU_ISSET(pinned_cpu, &set);
+}
+
+int test_pinned_work() {
+    printf("Test 18: Pinned stations and workers... ");
+    fflush(stdout);
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) TEST_FAIL("No affinity");
+    pinned_cpu = 0;
+    while (!CPU_ISSET(pinned_cpu, &allowed))
+        pinned_cpu++;
+
+    plant_cpu_set_t cpus = { .cpus = &pinned_cpu, .n_cpus = 1 };
+    int bad_cpu = -1;
+    plant_cpu_set_t bad_cpus = { .cpus = &bad_cpu, .n_cpus = 1 };
+
+    int pinned_stations[] = {1};
+    plant_options_t station_opts = { .station_cpus = &cpus };
+    plant_options_t bad_opts = { .station_cpus = &bad_cpus };
+    if (plant_create(pinned_stations, 1, 1, &bad_opts) != NULL) TEST_FAIL("Bad station CPU accepted");
+    plant_t* plants[2];
+    plants[0] = plant_create(pinned_stations, 1, 1, &station_opts);
+    plants[1] = plant_create(pinned_stations, 1, 2, NULL);
+    if (!plants[0] || !plants[1]) TEST_FAIL("Create failed");
+
+    time_t now = time(NULL);
+    worker_t workers[2];
+    worker_attr_t attrs[2] = { {0}, { .cpus = cpus } };
+    worker_attr_t bad_attr = { .cpus = bad_cpus };
+    task_t tasks[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_report_cpus };
+        tasks[i] = (task_t){ .id = 1800 + i, .start = now, .capacity = 1 };
+        tasks[i].results = plant_alloc_on_cpus(&cpus, sizeof(int));
+        if (!tasks[i].results || tasks[i].results[0] != 0) TEST_FAIL("Allocation failed");
+        plant_add_worker(plants[i], &workers[i], &attrs[i]);
+        plant_add_task(plants[i], &tasks[i], NULL);
+    }
+    int ok = plant_add_worker(plants[1], &workers[0], &bad_attr) == ERROR;
+
+    for (int i = 0; i < 2; i++) {
+        ok = plant_collect_task(plants[i], &tasks[i]) == PLANTOK && tasks[i].results[0] == 1 && ok;
+        ok = plant_destroy(plants[i]) == PLANTOK && ok;
+        cleanup_task_memory(&tasks[i]);
+    }
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Work didn't run on the pinned CPU");
+    }
+}
+
+/**
+ * Scenario 19: Padded Results
+ *
+ * Condition: A task of capacity 4 asks for padded result slots, all 4
+ *            workers return their index.
+ *
+ * Expected: The results still end up in `results`, in index order.
+ */
+int work_fn_index(worker_t* worker, task_t* task, int aux) {
+    return aux;
+}
+
+int test_padded_results() {
+    printf("Test 19: Padded result slots... ");
+    fflush(stdout);
+
+    int padded_stations[] = {4};
+    if (init_plant(padded_stations, 1, 4) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t workers[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_index };
+        add_worker(&workers[i]);
+    }
+
+    task_t t = { .id = 1900, .start = now, .capacity = 4 };
+    setup_task_memory(&t, 4);
+    task_attr_t attr = { .padded_results = true };
+    add_task_ex(&t, &attr);
+
+    int ok = collect_task(&t) == PLANTOK;
+    for (int i = 0; ok && i < 4; i++) {
+        if (t.results[i] != i) ok = 0;
+    }
+    destroy_plant();
+    cleanup_task_memory(&t);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Results weren't gathered from the slots");
+    }
+}
+
+/**
+ * Scenario 20: Statistics
+ *
+ * Condition: One station of capacity 1 and one worker get 3 tasks, one of
+ *            them needs 2 workers.
+ *
+ * Expected: plant_get_stats() counts 3 submitted tasks, 2 started and
+ *           completed, 1 infeasible, some work and no station still busy.
+ */
+int test_stats() {
+    printf("Test 20: Runtime statistics... ");
+    fflush(stdout);
+
+    int stats_stations[] = {1};
+    if (init_plant(stats_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t w = { .id = 1, .start = now, .end = now + 20, .work = work_fn_simple };
+    add_worker(&w);
+
+    task_t tasks[3];
+    for (int i = 0; i < 3; i++) {
+        tasks[i] = (task_t){ .id = 2000 + i, .start = now, .capacity = i == 2 ? 2 : 1 };
+        setup_task_memory(&tasks[i], tasks[i].capacity);
+        add_task(&tasks[i]);
+    }
+    int ok = collect_task(&tasks[0]) == PLANTOK &&
+             collect_task(&tasks[1]) == PLANTOK &&
+             collect_task(&tasks[2]) == ERROR;
+
+    plant_stats_t stats;
+    ok = plant_get_stats(NULL, &stats) == PLANTOK && ok;
+    destroy_plant();
+    for (int i = 0; i < 3; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && stats.tasks_submitted == 3 && stats.tasks_started == 2 &&
+         stats.tasks_completed == 2 && stats.tasks_infeasible == 1 &&
+         stats.manager_passes > 0 && stats.worker_busy_ns >= 20000000 &&
+         stats.station_busy_ns >= stats.worker_busy_ns && stats.stations_busy == 0 &&
+         plant_get_stats(NULL, &stats) == ERROR;
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Wrong counters");
+    }
+}
+
+/**
+ * Scenario 21: Tracing
+ *
+ * Condition: While tracing, 2 workers do 2 tasks of capacity 2 one after
+ *            another, then the trace is dumped.
+ *
+ * Expected: The dump has every lifecycle event: 2 add_task, 2 assign,
+ *           4 work begins and ends, 2 completed and 2 collected.
+ */
+int count_in_file(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[512];
+    int count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        for (char* at = strstr(line, needle); at; at = strstr(at + 1, needle))
+            count++;
+    }
+    fclose(f);
+    return count;
+}
+
+int test_trace() {
+    printf("Test 21: Trace dump... ");
+    fflush(stdout);
+
+    char path[] = "/tmp/plant_trace_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd == -1) TEST_FAIL("mkstemp failed");
+    close(fd);
+
+    int trace_stations[] = {2};
+    if (init_plant(trace_stations, 1, 2) != PLANTOK) TEST_FAIL("Init failed");
+    if (plant_trace_start(256) != PLANTOK) TEST_FAIL("Trace start failed");
+
+    time_t now = time(NULL);
+    worker_t workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_instant };
+        add_worker(&workers[i]);
+    }
+
+    int ok = 1;
+    task_t tasks[2];
+    for (int i = 0; i < 2; i++) {
+        tasks[i] = (task_t){ .id = 2100 + i, .start = now, .capacity = 2 };
+        setup_task_memory(&tasks[i], 2);
+        add_task(&tasks[i]);
+        ok = collect_task(&tasks[i]) == PLANTOK && ok;
+    }
+
+    plant_trace_stop();
+    ok = plant_trace_dump(path) == PLANTOK && ok;
+    destroy_plant();
+    for (int i = 0; i < 2; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && count_in_file(path, "\"add_task\"") == 2 &&
+         count_in_file(path, "\"assign\"") == 2 &&
+         count_in_file(path, "\"ph\": \"B\"") == 4 &&
+         count_in_file(path, "\"ph\": \"E\"") == 4 &&
+         count_in_file(path, "\"completed\"") == 2 &&
+         count_in_file(path, "\"collected\"") == 2;
+    unlink(path);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Trace is missing events");
+    }
+}
+
+/**
+ * Scenario 22: Priority and Deadline Order
+ *
+ * Condition: A plant ordered by priority, with one worker, gets 4 tasks
+ *            that all start at the same moment: two of priority 1 with
+ *            deadlines, one of priority 1 without and one of priority 2.
+ *
+ * Expected: They run by priority, then by the earlier deadline, the task
+ *           without a deadline last.
+ */
+int run_order[4];
+atomic_int run_count;
+
+int work_fn_record_order(worker_t* worker, task_t* task, int aux) {
+    run_order[atomic_fetch_add(&run_count, 1)] = (int)task->id;
+    return 0;
+}
+
+int test_priority_order() {
+    printf("Test 22: Priority and deadline order... ");
+    fflush(stdout);
+
+    int order_stations[] = {1};
+    plant_options_t opts = { .order = PLANT_ORDER_PRIORITY };
+    plant_t* p = plant_create(order_stations, 1, 1, &opts);
+    if (!p) TEST_FAIL("Create failed");
+    atomic_store(&run_count, 0);
+
+    int64_t now = plant_now_ns();
+    worker_t w = { .id = 1, .work = work_fn_record_order };
+    worker_attr_t w_attr = { .start_ns = now, .end_ns = now + 20000000000LL };
+    plant_add_worker(p, &w, &w_attr);
+
+    /* Submitted in the reverse of the expected order. */
+    task_attr_t attrs[4] = {
+        { .start_ns = now + 200000000LL, .priority = 1 },
+        { .start_ns = now + 200000000LL, .priority = 1, .deadline_ns = now + 900000000LL },
+        { .start_ns = now + 200000000LL, .priority = 1, .deadline_ns = now + 500000000LL },
+        { .start_ns = now + 200000000LL, .priority = 2 },
+    };
+    task_t tasks[4];
+    for (int i = 0; i < 4; i++) {
+        tasks[i] = (task_t){ .id = i, .capacity = 1 };
+        setup_task_memory(&tasks[i], 1);
+        plant_add_task(p, &tasks[i], &attrs[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < 4; i++)
+        ok = plant_collect_task(p, &tasks[i]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 4; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && run_order[0] == 3 && run_order[1] == 2 && run_order[2] == 1 && run_order[3] == 0;
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Tasks ran out of order");
+    }
+}
+
+/**
+ * Scenario 23: Backfilling
+ *
+ * Condition: A backfilling plant with 2 workers and stations {1, 1, 2} runs
+ *            a long narrow task A. Then a wide task W, a short narrow task B
+ *            with an expected duration and 2 long narrow tasks N without one
+ *            are added.
+ *
+ * Expected: B ends before A, so it goes ahead of W. The N tasks would keep
+ *           a worker busy when A ends, so they wait for W.
+ */
+int backfill_order[5];
+atomic_int backfill_count;
+
+int work_fn_backfill(worker_t* worker, task_t* task, int aux) {
+    if (aux == 0)
+        backfill_order[atomic_fetch_add(&backfill_count, 1)] = (int)task->id;
+    usleep(task->id == 0 || task->id >= 3 ? 200000 : 10000);
+    return 0;
+}
+
+int test_backfill() {
+    printf("Test 23: Backfilling around a wide task... ");
+    fflush(stdout);
+
+    int backfill_stations[] = {1, 1, 2};
+    plant_options_t opts = { .backfill = true };
+    plant_t* p = plant_create(backfill_stations, 3, 2, &opts);
+    if (!p) TEST_FAIL("Create failed");
+    atomic_store(&backfill_count, 0);
+
+    time_t now = time(NULL);
+    worker_t workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_backfill };
+        plant_add_worker(p, &workers[i], NULL);
+    }
+
+    /* A, W, B, N, N */
+    int capacities[5] = {1, 2, 1, 1, 1};
+    task_attr_t attrs[5] = { [0] = { .expected_ns = 200000000LL }, [2] = { .expected_ns = 50000000LL } };
+    task_t tasks[5];
+    for (int i = 0; i < 5; i++) {
+        tasks[i] = (task_t){ .id = i, .start = now, .capacity = capacities[i] };
+        setup_task_memory(&tasks[i], capacities[i]);
+    }
+    plant_add_task(p, &tasks[0], &attrs[0]);
+    while (atomic_load(&backfill_count) == 0)
+        usleep(1000);
+    for (int i = 1; i < 5; i++)
+        plant_add_task(p, &tasks[i], &attrs[i]);
+
+    int ok = 1;
+    for (int i = 0; i < 5; i++)
+        ok = plant_collect_task(p, &tasks[i]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 5; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && backfill_order[0] == 0 && backfill_order[1] == 2 && backfill_order[2] == 1;
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Wide task was starved");
+    }
+}
+
+/**
+ * Scenario 24: Feasibility by Shift Ends
+ *
+ * Condition: A plant for 4 workers gets 2 workers whose shifts end before
+ *            2 tasks start, one task needs 3 workers and one needs 2. Then
+ *            2 workers with long shifts are added.
+ *
+ * Expected: The first task fails at once, only 2 workers can still come.
+ *           The second one runs on the workers added later.
+ */
+int test_shift_end_feasibility() {
+    printf("Test 24: Feasibility by shift ends... ");
+    fflush(stdout);
+
+    int shift_stations[] = {3};
+    plant_t* p = plant_create(shift_stations, 1, 4, NULL);
+    if (!p) TEST_FAIL("Create failed");
+
+    int64_t now = plant_now_ns();
+    worker_t workers[4];
+    worker_attr_t w_attrs[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = (worker_t){ .id = i, .work = work_fn_instant };
+        w_attrs[i] = (worker_attr_t){ .start_ns = now, .end_ns = now + (i < 2 ? 100000000LL : 20000000000LL) };
+    }
+    plant_add_worker(p, &workers[0], &w_attrs[0]);
+    plant_add_worker(p, &workers[1], &w_attrs[1]);
+
+    task_attr_t t_attr = { .start_ns = now + 300000000LL };
+    task_t tasks[2];
+    for (int i = 0; i < 2; i++) {
+        tasks[i] = (task_t){ .id = 2400 + i, .capacity = 3 - i };
+        setup_task_memory(&tasks[i], tasks[i].capacity);
+        plant_add_task(p, &tasks[i], &t_attr);
+    }
+    int ok = plant_collect_task(p, &tasks[0]) == ERROR && plant_now_ns() < t_attr.start_ns;
+
+    plant_add_worker(p, &workers[2], &w_attrs[2]);
+    plant_add_worker(p, &workers[3], &w_attrs[3]);
+    ok = plant_collect_task(p, &tasks[1]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 2; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Wrong feasibility");
+    }
+}
+
+/**
+ * Scenario 25: Mass Shift End
+ *
+ * Condition: 50 workers whose shifts end soon and 1 long one are all busy
+ *            with 2 tasks, working past those shifts. A task needing 2
+ *            workers waits meanwhile.
+ *
+ * Expected: When the 50 workers leave together, the waiting task fails
+ *           and the other 2 complete.
+ */
+atomic_int mass_started;
+
+int work_fn_mass_exit(worker_t* worker, task_t* task, int aux) {
+    atomic_fetch_add(&mass_started, 1);
+    usleep(task->id == 2500 ? 700000 : 900000);
+    return 0;
+}
+
+int test_mass_shift_end() {
+    printf("Test 25: Mass shift end... ");
+    fflush(stdout);
+
+    int mass_stations[] = {1, 50, 2};
+    plant_t* p = plant_create(mass_stations, 3, 51, NULL);
+    if (!p) TEST_FAIL("Create failed");
+
+    atomic_store(&mass_started, 0);
+    int64_t now = plant_now_ns();
+    worker_t workers[51];
+    for (int i = 0; i < 51; i++) {
+        workers[i] = (worker_t){ .id = i, .work = work_fn_mass_exit };
+        worker_attr_t attr = { .start_ns = now, .end_ns = now + (i < 50 ? 500000000LL : 20000000000LL) };
+        plant_add_worker(p, &workers[i], &attr);
+    }
+
+    /* One after another, so the widest one gets the workers ending first. */
+    task_t tasks[3];
+    int capacities[3] = {50, 1, 2};
+    for (int i = 0; i < 3; i++) {
+        tasks[i] = (task_t){ .id = 2500 + i, .start = time(NULL), .capacity = capacities[i] };
+        setup_task_memory(&tasks[i], capacities[i]);
+        plant_add_task(p, &tasks[i], NULL);
+        if (i == 0) {
+            while (atomic_load(&mass_started) < 50 && plant_now_ns() < now + 500000000LL)
+                usleep(1000);
+        }
+    }
+
+    int ok = plant_collect_task(p, &tasks[2]) == ERROR &&
+             plant_collect_task(p, &tasks[0]) == PLANTOK &&
+             plant_collect_task(p, &tasks[1]) == PLANTOK;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 3; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Waiting task wasn't failed");
+    }
+}
+
+/**
+ * Scenario 26: Sticky Workers
+ *
+ * Condition: A plant with sticky workers and stations {1, 2} has 3 workers,
+ *            w0 leaving first and w2 last. A task of capacity 2 takes w0 and
+ *            w1 to the big station, meanwhile one of capacity 1 takes w2 to
+ *            the small one. Then another task of capacity 1 comes.
+ *
+ * Expected: It goes to the small station with w2, which worked there,
+ *           not with w0 that leaves first.
+ */
+int sticky_worker_of[3];
+
+int work_fn_sticky(worker_t* worker, task_t* task, int aux) {
+    if (aux == 0)
+        sticky_worker_of[task->id - 2600] = worker->id;
+    if (task->id == 2600)
+        usleep(300000);
+    return 0;
+}
+
+int test_sticky_workers() {
+    printf("Test 26: Sticky workers... ");
+    fflush(stdout);
+
+    int sticky_stations[] = {1, 2};
+    plant_options_t opts = { .sticky_workers = true };
+    plant_t* p = plant_create(sticky_stations, 2, 3, &opts);
+    if (!p) TEST_FAIL("Create failed");
+
+    time_t now = time(NULL);
+    worker_t workers[3];
+    for (int i = 0; i < 3; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 10 * (i + 1), .work = work_fn_sticky };
+        plant_add_worker(p, &workers[i], NULL);
+    }
+
+    task_t tasks[3];
+    int capacities[3] = {2, 1, 1};
+    for (int i = 0; i < 3; i++) {
+        /* Equal starts could be released in any order. */
+        tasks[i] = (task_t){ .id = 2600 + i, .start = now - 3 + i, .capacity = capacities[i] };
+        setup_task_memory(&tasks[i], capacities[i]);
+    }
+    plant_add_task(p, &tasks[0], NULL);
+    plant_add_task(p, &tasks[1], NULL);
+    int ok = plant_collect_task(p, &tasks[0]) == PLANTOK &&
+             plant_collect_task(p, &tasks[1]) == PLANTOK;
+    plant_add_task(p, &tasks[2], NULL);
+    ok = plant_collect_task(p, &tasks[2]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 3; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && sticky_worker_of[1] == 2 && sticky_worker_of[2] == 2;
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task didn't get the station's worker");
+    }
+}
+
+/**
+ * Scenario 27: Batch Task Function
+ *
+ * Condition: A task of capacity 3 with a batch function doubling its 10
+ *            items, done by workers whose work function fails the test.
+ *
+ * Expected: Every result is doubled, in 3 batch calls and no call of the
+ *           work function.
+ */
+atomic_int batch_calls;
+atomic_int batch_work_calls;
+
+void batch_double(const int* in, int* out, int n) {
+    atomic_fetch_add(&batch_calls, 1);
+    for (int i = 0; i < n; i++)
+        out[i] = 2 * in[i];
+}
+
+int work_fn_count(worker_t* worker, task_t* task, int aux) {
+    atomic_fetch_add(&batch_work_calls, 1);
+    return -1;
+}
+
+int test_batch_function() {
+    printf("Test 27: Batch task function... ");
+    fflush(stdout);
+
+    int batch_stations[] = {3};
+    if (init_plant(batch_stations, 1, 3) != PLANTOK) TEST_FAIL("Init failed");
+    atomic_store(&batch_calls, 0);
+    atomic_store(&batch_work_calls, 0);
+
+    time_t now = time(NULL);
+    worker_t workers[3];
+    for (int i = 0; i < 3; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_count };
+        add_worker(&workers[i]);
+    }
+
+    int data[10];
+    int results[10] = {0};
+    for (int i = 0; i < 10; i++)
+        data[i] = i + 1;
+    task_t t = { .id = 2700, .start = now, .capacity = 3, .data = data, .results = results };
+    task_attr_t attr = { .batch_function = batch_double, .n_items = 10, .padded_results = true };
+    add_task_ex(&t, &attr);
+
+    int ok = collect_task(&t) == PLANTOK;
+    destroy_plant();
+
+    for (int i = 0; i < 10; i++)
+        ok = ok && results[i] == 2 * data[i];
+    ok = ok && atomic_load(&batch_calls) == 3 && atomic_load(&batch_work_calls) == 0;
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Wrong batch results");
+    }
+}
+
+/**
+ * Scenario 28: Moldable Tasks
+ *
+ * Condition: A station of capacity 6 and only 3 workers. A task of capacity
+ *            6 that may start with 2 workers, and one that needs 4.
+ *
+ * Expected: The first one runs on all 3 workers, every index done once.
+ *           The second one can never get its minimum and fails.
+ */
+atomic_int moldable_calls;
+atomic_int moldable_worker_mask;
+
+int work_fn_moldable(worker_t* worker, task_t* task, int aux) {
+    atomic_fetch_add(&moldable_calls, 1);
+    atomic_fetch_or(&moldable_worker_mask, 1 << worker->id);
+    return aux + 1;
+}
+
+int test_moldable_task() {
+    printf("Test 28: Moldable task... ");
+    fflush(stdout);
+
+    int moldable_stations[] = {6};
+    if (init_plant(moldable_stations, 1, 3) != PLANTOK) TEST_FAIL("Init failed");
+    atomic_store(&moldable_calls, 0);
+    atomic_store(&moldable_worker_mask, 0);
+
+    time_t now = time(NULL);
+    worker_t workers[3];
+    for (int i = 0; i < 3; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_moldable };
+        add_worker(&workers[i]);
+    }
+
+    task_t tasks[2];
+    task_attr_t attrs[2] = { { .min_capacity = 2 }, { .min_capacity = 4 } };
+    for (int i = 0; i < 2; i++) {
+        tasks[i] = (task_t){ .id = 2800 + i, .start = now, .capacity = 6 };
+        setup_task_memory(&tasks[i], 6);
+        add_task_ex(&tasks[i], &attrs[i]);
+    }
+
+    int ok = collect_task(&tasks[0]) == PLANTOK && collect_task(&tasks[1]) == ERROR;
+    destroy_plant();
+
+    for (int i = 0; i < 6; i++)
+        ok = ok && tasks[0].results[i] == i + 1;
+    ok = ok && atomic_load(&moldable_calls) == 6 && atomic_load(&moldable_worker_mask) == 7;
+    for (int i = 0; i < 2; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Moldable task wasn't split");
+    }
+}
+
+/**
+ * Scenario 29: Failed Waiting Task Is Retired
+ *
+ * Condition: Both workers are busy, one of them until after its shift.
+ *            A task needing both waits, and fails once that worker leaves
+ *            while the other one is still busy. It is collected and its
+ *            id is added again with capacity 1.
+ *
+ * Expected: The new task isn't taken for the failed one, it runs on the
+ *           remaining worker and succeeds.
+ */
+atomic_int reused_started;
+
+int work_fn_reused_id(worker_t* worker, task_t* task, int aux) {
+    atomic_fetch_add(&reused_started, 1);
+    if (task->id == 2900)
+        usleep(600000);
+    else if (task->id == 2901)
+        usleep(1500000);
+    return 0;
+}
+
+int test_failed_id_reused() {
+    printf("Test 29: Failed waiting task id reused... ");
+    fflush(stdout);
+
+    int reused_stations[] = {1, 1, 2};
+    if (init_plant(reused_stations, 3, 2) != PLANTOK) TEST_FAIL("Init failed");
+    atomic_store(&reused_started, 0);
+
+    int64_t now = plant_now_ns();
+    worker_t workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .work = work_fn_reused_id };
+        worker_attr_t attr = { .start_ns = now, .end_ns = now + (i == 0 ? 300000000LL : 20000000000LL) };
+        add_worker_ex(&workers[i], &attr);
+    }
+
+    task_t busy[2];
+    for (int i = 0; i < 2; i++) {
+        busy[i] = (task_t){ .id = 2900 + i, .start = time(NULL), .capacity = 1 };
+        setup_task_memory(&busy[i], 1);
+        add_task(&busy[i]);
+    }
+    while (atomic_load(&reused_started) < 2)
+        usleep(1000);
+
+    task_t wide = { .id = 2902, .start = time(NULL), .capacity = 2 };
+    setup_task_memory(&wide, 2);
+    add_task(&wide);
+    int ok = collect_task(&wide) == ERROR;
+
+    wide.capacity = 1;
+    ok = ok && add_task(&wide) == PLANTOK;
+    ok = ok && collect_task(&wide) == PLANTOK && atomic_load(&reused_started) == 3;
+    for (int i = 0; i < 2; i++)
+        ok = ok && collect_task(&busy[i]) == PLANTOK;
+    destroy_plant();
+
+    for (int i = 0; i < 2; i++)
+        cleanup_task_memory(&busy[i]);
+    cleanup_task_memory(&wide);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Collected failed task kept its id");
+    }
+}
+
+/**
+ * Scenario 30: Moldable Task Around a Reservation
+ *
+ * Condition: A backfilling plant with 6 workers and stations {1, 3, 4} runs
+ *            a task A of capacity 3 with an expected duration. Then a wide
+ *            task W of capacity 4 and a moldable task M of capacity 2,
+ *            that may start with 1 worker, are added.
+ *
+ * Expected: M can't take the station reserved for W, so it runs with
+ *           1 worker on the small station and W starts when A ends,
+ *           before M is done.
+ */
+atomic_llong reserved_w_start;
+atomic_llong reserved_m_end;
+
+int work_fn_reserved(worker_t* worker, task_t* task, int aux) {
+    if (task->id == 3001 && aux == 0)
+        atomic_store(&reserved_w_start, plant_now_ns());
+    usleep(task->id == 3000 ? 300000 : task->id == 3002 ? 400000 : 10000);
+    if (task->id == 3002)
+        atomic_store(&reserved_m_end, plant_now_ns());
+    return 0;
+}
+
+int test_moldable_backfill() {
+    printf("Test 30: Moldable task around a reservation... ");
+    fflush(stdout);
+
+    int reserved_stations[] = {1, 3, 4};
+    plant_options_t opts = { .backfill = true };
+    plant_t* p = plant_create(reserved_stations, 3, 6, &opts);
+    if (!p) TEST_FAIL("Create failed");
+    atomic_store(&reserved_w_start, 0);
+    atomic_store(&reserved_m_end, 0);
+
+    time_t now = time(NULL);
+    worker_t workers[6];
+    for (int i = 0; i < 6; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_reserved };
+        plant_add_worker(p, &workers[i], NULL);
+    }
+
+    /* A, W, M */
+    int capacities[3] = {3, 4, 2};
+    task_attr_t attrs[3] = { [0] = { .expected_ns = 300000000LL }, [2] = { .min_capacity = 1 } };
+    task_t tasks[3];
+    for (int i = 0; i < 3; i++) {
+        tasks[i] = (task_t){ .id = 3000 + i, .start = now, .capacity = capacities[i] };
+        setup_task_memory(&tasks[i], capacities[i]);
+    }
+    plant_add_task(p, &tasks[0], &attrs[0]);
+    plant_stats_t stats = {0};
+    while (stats.tasks_started == 0 && plant_get_stats(p, &stats) == PLANTOK)
+        usleep(1000);
+    for (int i = 1; i < 3; i++)
+        plant_add_task(p, &tasks[i], &attrs[i]);
+
+    int ok = 1;
+    for (int i = 0; i < 3; i++)
+        ok = plant_collect_task(p, &tasks[i]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 3; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    ok = ok && atomic_load(&reserved_w_start) < atomic_load(&reserved_m_end);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Moldable task took the reserved station");
+    }
+}
+
+/**
+ * Scenario 31: Trace Restart
+ *
+ * Condition: Tracing starts with 2 events per thread and 4 tasks are added
+ *            and collected one by one, then it restarts with 64 events per
+ *            thread for 4 more tasks. The trace is dumped after each round.
+ *
+ * Expected: The first dump keeps only the last events of the collecting
+ *           thread, the second one has all 4 of its add_task events.
+ */
+int trace_round(const char* path, int events_per_thread, int first_id) {
+    if (plant_trace_start(events_per_thread) != PLANTOK)
+        return -1;
+
+    time_t now = time(NULL);
+    int ok = 1;
+    for (int i = 0; i < 4; i++) {
+        task_t t = { .id = first_id + i, .start = now, .capacity = 1 };
+        setup_task_memory(&t, 1);
+        add_task(&t);
+        ok = collect_task(&t) == PLANTOK && ok;
+        cleanup_task_memory(&t);
+    }
+
+    plant_trace_stop();
+    if (!ok || plant_trace_dump(path) != PLANTOK)
+        return -1;
+    return count_in_file(path, "\"add_task\"");
+}
+
+int test_trace_restart() {
+    printf("Test 31: Trace restart with another size... ");
+    fflush(stdout);
+
+    char path[] = "/tmp/plant_trace_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd == -1) TEST_FAIL("mkstemp failed");
+    close(fd);
+
+    int trace_stations[] = {1};
+    if (init_plant(trace_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+    time_t now = time(NULL);
+    worker_t w = { .id = 1, .start = now, .end = now + 20, .work = work_fn_instant };
+    add_worker(&w);
+
+    int small = trace_round(path, 2, 3100);
+    int large = trace_round(path, 64, 3200);
+    destroy_plant();
+    unlink(path);
+
+    if (small >= 0 && small <= 2 && large == 4) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Trace rings kept their first size");
+    }
+}
+
+/**
+ * Scenario 32: Drain Order
+ *
+ * Condition: One worker does 4 tasks one after another, all collected
+ *            asynchronously without a callback. Once all are done they are
+ *            drained one per call.
+ *
+ * Expected: The tasks are reported in the order they completed.
+ */
+int test_drain_order() {
+    printf("Test 32: Drain keeps completion order... ");
+    fflush(stdout);
+
+    int drain_stations[] = {1};
+    if (init_plant(drain_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    time_t now = time(NULL);
+    worker_t w = { .id = 1, .start = now, .end = now + 20, .work = work_fn_simple };
+    add_worker(&w);
+
+    /* Different starts, so they are released in this order. */
+    task_t tasks[4];
+    int ok = 1;
+    for (int i = 0; i < 4; i++) {
+        tasks[i] = (task_t){ .id = 3200 + i, .start = now - 4 + i, .capacity = 1 };
+        setup_task_memory(&tasks[i], 1);
+        add_task(&tasks[i]);
+        ok = collect_task_async(&tasks[i], NULL, NULL) == PLANTOK && ok;
+    }
+
+    plant_stats_t stats = {0};
+    while (ok && stats.tasks_completed < 4 && plant_get_stats(NULL, &stats) == PLANTOK)
+        usleep(1000);
+
+    for (int i = 0; ok && i < 4; i++) {
+        int id, status;
+        ok = plant_drain_completed(NULL, &id, &status, 1) == 1 && id == 3200 + i && status == PLANTOK;
+    }
+    destroy_plant();
+
+    for (int i = 0; i < 4; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    if (ok) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Drained tasks out of order");
+    }
+}
+
+/**
+ * Scenario 33: Future Task Failed by a New Worker
+ *
+ * Condition: A plant for 2 workers gets a task of capacity 2 starting
+ *            3 seconds from now. Then a worker whose shift ends in 1 second
+ *            and a long one are added.
+ *
+ * Expected: The short shift is over by the task's start, so the task fails
+ *           as soon as the worker is registered, not when it would start.
+ */
+int test_future_task_new_worker() {
+    printf("Test 33: Future task failed by a new worker... ");
+    fflush(stdout);
+
+    int future_stations[] = {2};
+    if (init_plant(future_stations, 1, 2) != PLANTOK) TEST_FAIL("Init failed");
+
+    int64_t now = plant_now_ns();
+    task_t t = { .id = 3300, .capacity = 2 };
+    setup_task_memory(&t, 2);
+    task_attr_t attr = { .start_ns = now + 3000000000LL };
+    add_task_ex(&t, &attr);
+    usleep(50000);
+
+    worker_t workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = (worker_t){ .id = i, .work = work_fn_instant };
+        worker_attr_t wattr = { .start_ns = now, .end_ns = now + (i == 0 ? 1000000000LL : 20000000000LL) };
+        add_worker_ex(&workers[i], &wattr);
+    }
+
+    int res = collect_task(&t);
+    int64_t elapsed = plant_now_ns() - now;
+    destroy_plant();
+    cleanup_task_memory(&t);
+
+    if (res == ERROR && elapsed < 1000000000LL) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Task failed only at its start");
+    }
+}
+
+/**
+ * Scenario 34: Reservation Dated by Upcoming Workers
+ *
+ * Condition: A backfilling plant with stations {4, 1} has 1 worker on
+ *            shift and 3 starting 1 second from now. A task W of capacity 4
+ *            and a task N of capacity 1 expected to take 1 ms are added.
+ *
+ * Expected: W can start once the 3 workers arrive, N ends well before that
+ *           and doesn't wait for them. W still runs.
+ */
+int test_upcoming_reservation() {
+    printf("Test 34: Reservation dated by upcoming workers... ");
+    fflush(stdout);
+
+    int upcoming_stations[] = {4, 1};
+    plant_options_t opts = { .backfill = true };
+    plant_t* p = plant_create(upcoming_stations, 2, 4, &opts);
+    if (!p) TEST_FAIL("Create failed");
+
+    int64_t now = plant_now_ns();
+    worker_t workers[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = (worker_t){ .id = i, .work = work_fn_instant };
+        worker_attr_t wattr = { .start_ns = i == 0 ? now : now + 1000000000LL, .end_ns = now + 20000000000LL };
+        plant_add_worker(p, &workers[i], &wattr);
+    }
+
+    /* W, N */
+    task_t tasks[2] = {
+        { .id = 3400, .start = time(NULL), .capacity = 4 },
+        { .id = 3401, .start = time(NULL), .capacity = 1 },
+    };
+    task_attr_t attrs[2] = { [1] = { .expected_ns = 1000000LL } };
+    for (int i = 0; i < 2; i++) {
+        setup_task_memory(&tasks[i], tasks[i].capacity);
+        plant_add_task(p, &tasks[i], &attrs[i]);
+    }
+
+    int ok = plant_collect_task(p, &tasks[1]) == PLANTOK;
+    int64_t narrow_done = plant_now_ns() - now;
+    ok = plant_collect_task(p, &tasks[0]) == PLANTOK && ok;
+    ok = plant_destroy(p) == PLANTOK && ok;
+    for (int i = 0; i < 2; i++)
+        cleanup_task_memory(&tasks[i]);
+
+    if (ok && narrow_done < 500000000LL) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Narrow task waited for the upcoming workers");
+    }
+}
+
+/**
+ * Scenario 35: Shift Without End
+ *
+ * Condition: A worker is added with `.end = LLONG_MAX`, then a task of
+ *            capacity 1.
+ *
+ * Expected: The shift lasts forever rather than wrapping into the past,
+ *           so the task runs and the plant is destroyed right after.
+ */
+int test_endless_shift() {
+    printf("Test 35: Shift without end... ");
+    fflush(stdout);
+
+    int endless_stations[] = {1};
+    if (init_plant(endless_stations, 1, 1) != PLANTOK) TEST_FAIL("Init failed");
+
+    worker_t w = { .id = 0, .start = time(NULL), .end = LLONG_MAX, .work = work_fn_instant };
+    add_worker(&w);
+    task_t t = { .id = 3500, .start = time(NULL), .capacity = 1 };
+    setup_task_memory(&t, 1);
+    add_task(&t);
+
+    int res = collect_task(&t);
+    int destroyed = destroy_plant();
+    cleanup_task_memory(&t);
+
+    if (res == PLANTOK && destroyed == PLANTOK) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Endless shift was treated as over");
+    }
+}
+
+/**
+ * Scenario 36: Trace Dump While Recording
+ *
+ * Condition: 4 workers run 100 tasks while another thread keeps restarting
+ *            the trace with 4 events per thread, which the rings overrun,
+ *            and dumping it.
+ *
+ * Expected: Every dumped event belongs to one of the tasks, none is torn
+ *           by its thread writing the slot meanwhile.
+ */
+atomic_bool trace_busy_done;
+char trace_busy_path[] = "/tmp/plant_trace_XXXXXX";
+
+void* trace_busy_dumper(void* arg) {
+    int* bad = arg;
+    while (!atomic_load(&trace_busy_done)) {
+        plant_trace_start(4);
+        usleep(500);
+        if (plant_trace_dump(trace_busy_path) != PLANTOK ||
+            count_in_file(trace_busy_path, "\"ph\"") != count_in_file(trace_busy_path, "\"task\": 36"))
+            (*bad)++;
+    }
+    return NULL;
+}
+
+int test_trace_busy_dump() {
+    printf("Test 36: Trace dump while recording... ");
+    fflush(stdout);
+
+    int fd = mkstemp(trace_busy_path);
+    if (fd == -1) TEST_FAIL("mkstemp failed");
+    close(fd);
+
+    int busy_stations[] = {1, 1, 1, 1};
+    if (init_plant(busy_stations, 4, 4) != PLANTOK) TEST_FAIL("Init failed");
+    time_t now = time(NULL);
+    worker_t workers[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = (worker_t){ .id = i, .start = now, .end = now + 20, .work = work_fn_instant };
+        add_worker(&workers[i]);
+    }
+
+    int bad = 0;
+    pthread_t dumper;
+    atomic_store(&trace_busy_done, false);
+    pthread_create(&dumper, NULL, trace_busy_dumper, &bad);
+
+    task_t tasks[100];
+    for (int i = 0; i < 100; i++) {
+        tasks[i] = (task_t){ .id = 3600 + i, .start = now, .capacity = 1 };
+        setup_task_memory(&tasks[i], 1);
+        add_task(&tasks[i]);
+    }
+    int ok = 1;
+    for (int i = 0; i < 100; i++)
+        ok = collect_task(&tasks[i]) == PLANTOK && ok;
+
+    atomic_store(&trace_busy_done, true);
+    pthread_join(dumper, NULL);
+    plant_trace_stop();
+    destroy_plant();
+    for (int i = 0; i < 100; i++)
+        cleanup_task_memory(&tasks[i]);
+    unlink(trace_busy_path);
+
+    if (ok && bad == 0) {
+        TEST_PASS();
+        return 0;
+    } else {
+        TEST_FAIL("Dump had events of no task");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Main                                    */
+/* -------------------------------------------------------------------------- */
+
+int main() {
+    printf("==========================================\n");
+    printf("     Advanced Plant Logic Tests           \n");
+    printf("==========================================\n\n");
+
+    int fail_count = 0;
+    if (test_worker_ends_before_task_starts() != 0) fail_count++;
+    if (test_destroy_waits_for_future() != 0) fail_count++;
+    if (test_worker_starts_late() != 0) fail_count++;
+    if (test_destroy_waits_multiple_future() != 0) fail_count++;
+    if (test_worker_tight_schedule() != 0) fail_count++;
+    if (test_mixed_destroy() != 0) fail_count++;
+    if (test_massive_parallelism() != 0) fail_count++;
+    
+    if (test_concurrent_clients() != 0) fail_count++;
+    if (test_best_fit_station() != 0) fail_count++;
+    if (test_collected_tasks_retired() != 0) fail_count++;
+    if (test_sub_second_start() != 0) fail_count++;
+    if (test_pool_threads() != 0) fail_count++;
+    if (test_concurrent_submissions() != 0) fail_count++;
+    if (test_batch_calls() != 0) fail_count++;
+    if (test_async_collect() != 0) fail_count++;
+    if (test_independent_plants() != 0) fail_count++;
+    if (test_pinned_work() != 0) fail_count++;
+    if (test_padded_results() != 0) fail_count++;
+    if (test_stats() != 0) fail_count++;
+    if (test_trace() != 0) fail_count++;
+    if (test_priority_order() != 0) fail_count++;
+    if (test_backfill() != 0) fail_count++;
+    if (test_shift_end_feasibility() != 0) fail_count++;
+    if (test_mass_shift_end() != 0) fail_count++;
+    if (test_sticky_workers() != 0) fail_count++;
+    if (test_batch_function() != 0) fail_count++;
+    if (test_moldable_task() != 0) fail_count++;
+    if (test_failed_id_reused() != 0) fail_count++;
+    if (test_moldable_backfill() != 0) fail_count++;
+    if (test_trace_restart() != 0) fail_count++;
+    if (test_drain_order() != 0) fail_count++;
+    if (test_future_task_new_worker() != 0) fail_count++;
+    if (test_upcoming_reservation() != 0) fail_count++;
+    if (test_endless_shift() != 0) fail_count++;
+    if (test_trace_busy_dump() != 0) fail_count++;
+    printf("RANDOMIZED TESTS, IF THERE WAS ERROR ON TEST I, \n YOU CAN JUST CALL `test_stress_mixed_ops(i)` AND ANALYZE WITH VALGRIND\n ");
+    printf("FOR EXAMPLE:  valgrind --leak-check=full --show-leak-kinds=all --track-origins=yes --trace-children=yes --fair-sched=yes --log-file=valgrind-out.txt ./demo");
+    
+    printf("\n==========================================\n");
+    if (fail_count == 0) {
+        printf(GREEN "ALL ADVANCED TESTS PASSED.\n" RESET);
+        return 0;
+    } else {
+        printf(RED "%d TESTS FAILED.\n" RESET, fail_count);
+        return 1;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../../common/plant.h"
+
+/* Converts the public CPU list, -1 if a CPU number is out of range.
+   An empty list gives an empty set, which means "not pinned". */
+int affinity_from_cpus(cpu_set_t* set, const plant_cpu_set_t* cpus);
+bool affinity_pinned(const cpu_set_t* set);
+
+/* Moves the calling thread onto `set`. Best effort, a CPU that went
+   offline only costs locality, so failures are ignored. */
+void affinity_apply(const cpu_set_t* set);
+
+/* `size` bytes written first from a thread on `set`, so their pages are
+   placed on that set's NUMA node. NULL on failure. */
+void* affinity_alloc(const cpu_set_t* set, size_t size);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef BACKFILL_H
+#define BACKFILL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "task_info.h"
+
+/* Start of a reservation that waits for work without an expected duration. */
+#define BACKFILL_UNKNOWN INT64_MAX
+
+/* A running task, by when its workers and station are expected back. */
+typedef struct {
+    int64_t end_ns;
+    int station;
+    int workers;
+    int station_capacity;
+} backfill_running_t;
+
+/* Reservation for the widest waiting task. If running tasks keep to their
+   expected durations it can start at `start_ns`, so other tasks may only go
+   ahead if they are expected to end by then, or if they take workers and
+   stations the reservation won't need. Workers not on shift yet count from
+   their shift start, shifts ending meanwhile aren't accounted for. A task
+   the known workers can't staff isn't reserved for, so it holds nothing
+   back until enough workers are added. */
+typedef struct {
+    task_info_t* task;
+    int64_t start_ns;
+    /* Free at `start_ns` on top of what the reserved task takes. */
+    int spare_workers;
+    int spare_stations;
+
+    /* Kept across passes, sorted by `end_ns`. */
+    backfill_running_t* running;
+    int n_running;
+} backfill_t;
+
+/* At most one running task per station. */
+int backfill_init(backfill_t* b, int n_stations);
+void backfill_destroy(backfill_t* b);
+
+/* Drops the reservation, the running tasks stay. */
+void backfill_clear(backfill_t* b);
+/* A task started on `station`, O(S) to keep the order. */
+void backfill_add_running(backfill_t* b, int station, int64_t end_ns, int workers, int station_capacity);
+/* The task on `station` ended, nothing if none was added. */
+void backfill_remove_running(backfill_t* b, int station);
+/* `idle` workers are on shift now, `fitting_stations` are free and big enough
+   for `task`. `starts` are the shift starts of the workers not on shift yet,
+   ascending. Walks the running tasks and starts only until the task fits. */
+void backfill_reserve(backfill_t* b, task_info_t* task, int idle, int fitting_stations,
+                      const int64_t* starts, size_t n_starts, int64_t now);
+/* Forgets the reservation if it is `task`'s. */
+void backfill_forget(backfill_t* b, const task_info_t* task);
+
+/* Whether `task` may start now with `workers` on a station of `station_capacity`. */
+bool backfill_allows(const backfill_t* b, const task_info_t* task, int workers, int station_capacity,
+                     int64_t now);
+/* Accounts for a task that just started, the reserved one ends the reservation. */
+void backfill_started(backfill_t* b, const task_info_t* task, int station_capacity, int64_t now);
+
+#endif
@@ -6,28 +6,108 @@
 #include <stdbool.h>
 #include <stdatomic.h>
 
+#include "affinity.h"
+#include "backfill.h"
+#include "job_queue.h"
+#include "lf_stack.h"
+#include "shift_index.h"
+#include "station_index.h"
+#include "stats.h"
+#include "task_heap.h"
 #include "task_list.h"
+#include "task_queue.h"
 #include "worker_list.h"
+#include "worker_pool.h"
 
 typedef struct factory_struct {
     /* Tere is a case where factory might be 
        terminated but still active */
-    bool is_active;
-    bool is_terminated;
+    atomic_bool is_active;
+    atomic_bool is_terminated;
 
     int* station_capacity;
-    int* station_usage;
+    /* Workers still busy at each station, counted down by the workers. */
+    atomic_int* station_usage;
     int n_stations;
+    station_index_t stations;
+    /* CPUs of every station, NULL if no station is pinned. */
+    cpu_set_t* station_cpus;
+    /* Where unpinned work runs, the CPUs the plant was started on. */
+    cpu_set_t all_cpus;
+    /* Task holding each station, NULL if it is free. */
+    task_info_t** station_task;
 
     task_container tasks;
+    /* Tasks waiting for their `start`, and tasks waiting for resources.
+       With PLANT_ORDER_PRIORITY the waiting ones are kept in `ready_heap`
+       and `ready_tasks` is only a scratch queue of the manager's pass. */
+    task_heap_t start_heap;
+    task_queue_t ready_tasks;
+    task_heap_t ready_heap;
+    bool priority_order;
+    uint64_t next_seq;
+    /* Remade every manager pass, if enabled. */
+    bool backfill_enabled;
+    backfill_t backfill;
+    /* The ready task to reserve for, kept as tasks come and go. When it
+       leaves the ready set the next reservation searches it again. */
+    task_info_t* backfill_widest;
+    bool backfill_widest_stale;
 
     worker_container workers;
+    worker_pool_t idle_workers;
+    /* Assign workers by the station they last worked at. */
+    bool sticky_workers;
+    /* Shift ends and starts of every registered worker. */
+    shift_index_t shift_ends;
+    shift_index_t shift_starts;
+    /* A shift ended since the manager's last pass, ready tasks may
+       have become infeasible. */
+    bool shifts_ended;
+    /* No task in the ready set is wider, refreshed when they are checked. */
+    int ready_widest;
+    /* Same for the tasks in the start heap. */
+    int pending_widest;
+
+    /* Handed back by workers without the factory lock, taken over by the manager. */
+    lf_stack_t finished_tasks;
+    lf_stack_t returned_workers;
+
+    /* Pushed by add_task and add_worker without the factory lock,
+       registered by whoever holds it next. */
+    lf_stack_t submitted_tasks;
+    lf_stack_t submitted_workers;
+    /* Worker slots promised to submitted workers, at most the capacity. */
+    atomic_int reserved_workers;
+
+    /* Completed tasks of asynchronous collectors, either waiting for the
+       manager to run their callbacks or for plant_drain_completed(). */
+    lf_stack_t async_callbacks;
+    lf_stack_t async_drain;
+    /* Taken from `async_drain` but not reported yet, oldest first.
+       Guarded by main_lock. */
+    lf_node_t* drain_leftover;
+    /* Eventfd signalled when `async_drain` stops being empty. */
+    int completion_fd;
 
     pthread_cond_t manager_cond;
     pthread_t manager_thread;
+
+    /* With pool threads, workers don't own a thread. Assigned workers
+       are queued as jobs and run by whichever pool thread is free. */
+    int n_pool_threads;
+    pthread_t* pool_threads;
+    job_queue_t jobs;
+    pthread_cond_t jobs_cond;
+    /* Guarded by the jobs lock, not the factory lock. */
+    bool pool_stopping;
+
+    /* Counters of plant_get_stats(), written by any thread. */
+    stats_t stats;
 } factory_t;
 
-/* No condition initialized here. we will do this inside mutex */
+/* No condition initialized here. we will do this inside mutex.
+   `f` has to be zeroed, so a failed init can be cleaned up by factory_destroy. */
 int factory_init(factory_t* f, int n_stations, int* station_capacities, int n_workers);
 void factory_destroy(factory_t* f);
 
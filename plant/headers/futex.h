@@ -0,0 +1,12 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <stdatomic.h>
+
+/* Sleeps while `*word == expected`. May return spuriously, so callers
+   check the word again. */
+void futex_wait(atomic_uint* word, unsigned expected);
+/* Wakes every thread sleeping on `word`. */
+void futex_wake_all(atomic_uint* word);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef ID_MAP_H
+#define ID_MAP_H
+
+#include <stddef.h>
+
+/* Open addressing (linear probing) map from an int id to a non-NULL pointer.
+   Removal shifts the following cluster back, so there are no tombstones. */
+typedef struct {
+    int key;
+    void* value;
+} id_map_slot_t;
+
+typedef struct {
+    id_map_slot_t* slots;
+    size_t mask;
+    size_t count;
+} id_map_t;
+
+int id_map_init(id_map_t* map, size_t expected);
+void id_map_destroy(id_map_t* map);
+
+void* id_map_get(const id_map_t* map, int key);
+/* Inserts or replaces, -1 only if growing the table failed. */
+int id_map_put(id_map_t* map, int key, void* value);
+void id_map_remove(id_map_t* map, int key);
+
+#endif
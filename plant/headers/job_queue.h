@@ -0,0 +1,19 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include <stdbool.h>
+#include "worker_info.h"
+
+/* FIFO of workers with an assigned task, waiting for a pool thread.
+   Linked through worker_info_t's `next_job`, so it never allocates. */
+typedef struct {
+    worker_info_t* head;
+    worker_info_t* tail;
+} job_queue_t;
+
+void job_queue_init(job_queue_t* queue);
+void job_queue_push(job_queue_t* queue, worker_info_t* w);
+worker_info_t* job_queue_pop(job_queue_t* queue);
+bool job_queue_empty(const job_queue_t* queue);
+
+#endif
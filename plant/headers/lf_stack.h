@@ -0,0 +1,33 @@
+#ifndef LF_STACK_H
+#define LF_STACK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Intrusive lock-free stack. Any thread may push, a single consumer takes
+   the whole content at once, so there is no ABA problem. */
+typedef struct lf_node {
+    struct lf_node* next;
+} lf_node_t;
+
+typedef struct {
+    _Atomic(lf_node_t*) head;
+} lf_stack_t;
+
+#define LF_CONTAINER_OF(node, type, member) \
+    ((type*)((char*)(node) - offsetof(type, member)))
+
+void lf_stack_init(lf_stack_t* stack);
+/* Returns true if the stack was empty, so one of concurrent pushers knows
+   the consumer has to be woken up. */
+bool lf_stack_push(lf_stack_t* stack, lf_node_t* node);
+/* Pushes the nodes `first` .. `last` already linked through `next` with one
+   CAS, `first` ends up on top. */
+bool lf_stack_push_chain(lf_stack_t* stack, lf_node_t* first, lf_node_t* last);
+/* Returns the nodes pushed so far, most recent first. */
+lf_node_t* lf_stack_take_all(lf_stack_t* stack);
+/* Same, but in the order they were pushed. */
+lf_node_t* lf_stack_take_all_fifo(lf_stack_t* stack);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef PLANT_CLOCK_H
+#define PLANT_CLOCK_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/* All scheduling uses nanoseconds on CLOCK_MONOTONIC, so wall clock jumps
+   don't move task starts, shifts or wakeups. */
+#define NS_PER_SEC 1000000000LL
+
+int64_t clock_now_ns(void);
+/* Monotonic time at which the wall clock will show `wall` seconds,
+   INT64_MAX or INT64_MIN if that is out of range. */
+int64_t clock_from_wall(time_t wall);
+struct timespec clock_to_timespec(int64_t ns);
+
+/* pthread_cond_init, with timed waits measured on CLOCK_MONOTONIC. */
+int clock_cond_init(pthread_cond_t* cond);
+
+#endif
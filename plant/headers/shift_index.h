@@ -0,0 +1,30 @@
+#ifndef SHIFT_INDEX_H
+#define SHIFT_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Shift ends (or starts) of the registered workers, for counting the shifts
+   that are over at a given time without walking every worker. New ends wait in an
+   unsorted tail that the next query sorts and merges in, so a batch of
+   registrations costs one merge. */
+typedef struct {
+    int64_t* ends;
+    /* Merge buffer, as big as `ends`. */
+    int64_t* scratch;
+    size_t capacity;
+    size_t count;
+    size_t sorted;
+} shift_index_t;
+
+int shift_index_init(shift_index_t* idx, size_t capacity);
+void shift_index_destroy(shift_index_t* idx);
+
+/* At most `capacity` ends are ever added. */
+void shift_index_add(shift_index_t* idx, int64_t end_ns);
+/* Number of shifts over at `t` (ending at or before it), O(log W) once merged. */
+size_t shift_index_ended_by(shift_index_t* idx, int64_t t);
+/* The ends after `t` in ascending order, `*n` of them. Valid until the next add. */
+const int64_t* shift_index_after(shift_index_t* idx, int64_t t, size_t* n);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef STATION_INDEX_H
+#define STATION_INDEX_H
+
+#include <stdbool.h>
+
+/* Free stations grouped into buckets of equal capacity, buckets sorted
+   ascending. A segment tree over the buckets keeps the number of free
+   stations, so the smallest free station that fits is found in O(log B). */
+typedef struct {
+    int n_buckets;
+    int* bucket_capacity;
+    /* Bucket b keeps its free stations in
+       free_stations[bucket_start[b] .. bucket_start[b] + free_count[b]). */
+    int* bucket_start;
+    int* free_count;
+    int* free_stations;
+    int* station_bucket;
+
+    int* tree;
+    int tree_leaves;
+
+    int max_capacity;
+} station_index_t;
+
+int station_index_init(station_index_t* idx, const int* capacities, int n_stations);
+void station_index_destroy(station_index_t* idx);
+
+/* O(1), tells if any station (free or not) can ever hold `needed` workers. */
+bool station_index_fits(const station_index_t* idx, int needed);
+
+/* Takes the smallest free station with capacity >= `needed`, -1 if none. */
+int station_index_acquire(station_index_t* idx, int needed);
+void station_index_release(station_index_t* idx, int station);
+/* The station station_index_acquire would take, without taking it. */
+int station_index_peek(const station_index_t* idx, int needed);
+/* Number of free stations with capacity >= `needed`, O(log B). */
+int station_index_free_fitting(const station_index_t* idx, int needed);
+/* Capacity of the biggest free station, 0 if none is free. O(log B). */
+int station_index_max_free(const station_index_t* idx);
+/* Number of free stations, O(1). */
+int station_index_free_count(const station_index_t* idx);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "task_info.h"
+
+typedef enum {
+    STAT_TASKS_SUBMITTED,
+    STAT_TASKS_STARTED,
+    STAT_TASKS_COMPLETED,
+    STAT_TASKS_INFEASIBLE,
+    STAT_MANAGER_WAKEUPS,
+    STAT_MANAGER_PASSES,
+    STAT_MANAGER_PASS_NS,
+    STAT_TASKS_EXAMINED,
+    STAT_WORKER_BUSY_NS,
+    STAT_WORKER_IDLE_NS,
+    STAT_STATION_BUSY_NS,
+    STAT_MAIN_LOCK_WAIT_NS,
+    STAT_COUNT
+} stat_t;
+
+/* Threads are spread over the shards, so they rarely write to the same
+   cache line. A read sums every shard. */
+#define STATS_SHARDS 16
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_llong values[STAT_COUNT];
+} stats_shard_t;
+
+typedef struct {
+    stats_shard_t shards[STATS_SHARDS];
+} stats_t;
+
+void stats_init(stats_t* stats);
+/* Relaxed add to the calling thread's shard. */
+void stats_add(stats_t* stats, stat_t stat, int64_t value);
+int64_t stats_read(const stats_t* stats, stat_t stat);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TASK_HEAP_H
+#define TASK_HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "task_info.h"
+
+/* True if `a` has to go before `b`. */
+typedef bool (*task_heap_before_t)(const task_info_t* a, const task_info_t* b);
+
+/* Min-heap of tasks in the order of `before`. Tasks inside have
+   their `sched` set to the heap's. */
+typedef struct {
+    task_info_t** items;
+    size_t capacity;
+    size_t count;
+    task_heap_before_t before;
+    task_sched_t sched;
+} task_heap_t;
+
+/* By start on the plant clock. */
+bool task_heap_by_start(const task_info_t* a, const task_info_t* b);
+/* Higher priority first, then earlier deadline, then registration order. */
+bool task_heap_by_priority(const task_info_t* a, const task_info_t* b);
+
+int task_heap_init(task_heap_t* heap, task_heap_before_t before, task_sched_t sched);
+void task_heap_destroy(task_heap_t* heap);
+
+int task_heap_push(task_heap_t* heap, task_info_t* task);
+task_info_t* task_heap_top(const task_heap_t* heap);
+task_info_t* task_heap_pop(task_heap_t* heap);
+void task_heap_remove(task_heap_t* heap, task_info_t* task);
+/* Drops the completed tasks in one go, in linear time. */
+void task_heap_remove_completed(task_heap_t* heap);
+
+#endif
@@ -1,23 +1,106 @@
 #ifndef TASK_INFO_H
 #define TASK_INFO_H
 
-#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "../../common/plant.h"
+#include "lf_stack.h"
 
+/* Where the manager keeps a task that still waits to be started. */
+typedef enum {
+    SCHED_NONE,
+    SCHED_START_HEAP,
+    SCHED_READY
+} task_sched_t;
+
+#define CACHE_LINE 64
+
+/* A worker's result on a cache line of its own, see task_attr_t's `padded_results`. */
 typedef struct {
+    _Alignas(CACHE_LINE) int value;
+} result_slot_t;
+
+/* Bits of a task's completion word. */
+#define TASK_DONE 1u
+/* A collector sleeps on the word, the publisher has to wake it. */
+#define TASK_WAITERS 2u
+/* An asynchronous collector is registered, see collect_task_async(). */
+#define TASK_ASYNC 4u
+
+typedef struct task_info {
     task_t* original_def;
+    /* Copy with every time resolved to the plant clock. */
+    task_attr_t attr;
     
-    pthread_cond_t task_complete_cond;
+    /* Collectors wait on it with futex, without any lock. `failed` is
+       written before TASK_DONE is set. */
+    atomic_uint completion;
+    /* Threads still publishing the completion, they may wake collectors
+       after TASK_DONE is set. The info isn't freed while any is, and
+       reusing it keeps the count. */
+    atomic_uint publishers;
 
-    int workers_assigned;
+    atomic_int workers_assigned;
+    /* Workers it started with, see task_info_min_workers(). */
+    int n_workers;
     int assigned_position;
+    /* When it got its station, for the station statistics. */
+    int64_t started_ns;
+
+    task_sched_t sched;
+    /* Position in the start heap, or in the ready heap once started. */
+    size_t heap_pos;
+    /* Registration order, breaks ties of the ready heap. */
+    uint64_t seq;
     
-    bool is_completed;
     bool failed;
+
+    /* With `staging` workers write to `slots`, the last one gathers them.
+       The slots are kept when the info is reused. */
+    bool staging;
+    result_slot_t* slots;
+    int n_slots;
+
+    /* Finished by its workers, but the manager hasn't freed its station yet. */
+    atomic_bool pending_release;
+    lf_node_t finished_node;
+
+    /* Collectors currently waiting, and whether one already got the answer. */
+    int collectors;
+    bool collected;
+
+    /* Written by collect_task_async() before it sets TASK_ASYNC, the task is
+       queued for its callback or the drain call once complete. */
+    task_callback_t callback;
+    void* callback_arg;
+    lf_node_t async_node;
+
+    /* Position in the task container, or the next entry on its free list. */
+    size_t cont_pos;
+    struct task_info* next_free;
 } task_info_t;
 
+/* Fewest workers the task can start with, `capacity` unless it is moldable. */
+static inline int task_info_min_workers(const task_info_t* info)
+{
+    int min = info->attr.min_capacity;
+    return min > 0 && min < info->original_def->capacity ? min : info->original_def->capacity;
+}
+
+static inline bool task_info_completed(const task_info_t* info)
+{
+    return atomic_load(&info->completion) & TASK_DONE;
+}
+
 int task_info_init(task_info_t* info, task_t* task_def);
+/* Reuses an initialized info for a new task. */
+void task_info_reset(task_info_t* info, task_t* task_def);
 void task_info_destroy(task_info_t* info);
 
+/* Makes the workers write to padded slots, -1 if they can't be allocated. */
+int task_info_stage_results(task_info_t* info);
+/* Copies the slots into the task's `results`, done by its last worker. */
+void task_info_gather_results(task_info_t* info);
+
 #endif
\ No newline at end of file
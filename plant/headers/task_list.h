@@ -1,20 +1,38 @@
 #ifndef TASK_LIST_H
 #define TASK_LIST_H
 
+#include <stdatomic.h>
 #include <stdlib.h>
+#include "id_map.h"
 #include "task_info.h"
 
+/* Retired task infos kept around for reuse, above that they are freed. */
+#define TASK_FREE_LIST_MAX 1024
+
 typedef struct {
     task_info_t** items;
     int capacity;
     int count;
+    /* task id -> task_info_t* */
+    id_map_t index;
+
+    task_info_t* free_list;
+    int free_count;
 
-    int waiting_ans;
+    /* Tasks and collectors the plant still owes an answer, may be
+       decremented by workers outside the factory lock. */
+    atomic_int waiting_ans;
 } task_container;
 
 int task_cont_init(task_container* cont);
+/* Takes an info from the free list (or allocates one) for `task_def`, NULL on failure. */
+task_info_t* task_cont_new_task(task_container* cont, task_t* task_def);
+void task_cont_recycle(task_container* cont, task_info_t* task);
 int task_cont_push_back(task_container* cont, task_info_t* task);
+/* Swap-removes the task and forgets its id, doesn't recycle it. */
+void task_cont_remove(task_container* cont, task_info_t* task);
 task_info_t* task_cont_get(task_container* cont, size_t index);
+task_info_t* task_cont_find(task_container* cont, int id);
 size_t task_cont_size(task_container* cont);
 void task_cont_destroy(task_container* cont);
 
@@ -0,0 +1,32 @@
+#ifndef TASK_QUEUE_H
+#define TASK_QUEUE_H
+
+#include <stddef.h>
+#include "task_info.h"
+
+/* Growable FIFO ring buffer of tasks. */
+typedef struct {
+    task_info_t** items;
+    size_t capacity;
+    size_t head;
+    size_t count;
+} task_queue_t;
+
+int task_queue_init(task_queue_t* queue);
+void task_queue_destroy(task_queue_t* queue);
+
+int task_queue_push(task_queue_t* queue, task_info_t* task);
+task_info_t* task_queue_pop(task_queue_t* queue);
+size_t task_queue_size(const task_queue_t* queue);
+/* The `i`-th task from the front, without popping it. */
+task_info_t* task_queue_at(const task_queue_t* queue, size_t i);
+/* Takes the `i`-th task out, leaving a gap until task_queue_close_gaps(). */
+task_info_t* task_queue_take(task_queue_t* queue, size_t i);
+/* Puts a task taken from the `i`-th place back there. */
+void task_queue_put_back(task_queue_t* queue, size_t i, task_info_t* task);
+/* Closes the gaps among the first `n` places, keeping the order of the tasks. */
+void task_queue_close_gaps(task_queue_t* queue, size_t n);
+/* Drops the completed tasks, keeping the order of the others. */
+void task_queue_remove_completed(task_queue_t* queue);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "plant_clock.h"
+
+/* Task lifecycle points, see plant_trace_start(). */
+typedef enum {
+    TRACE_ADD_TASK,
+    TRACE_ASSIGN,
+    TRACE_WORK_BEGIN,
+    TRACE_WORK_END,
+    TRACE_COMPLETED,
+    TRACE_COLLECTED
+} trace_type_t;
+
+extern atomic_bool trace_on;
+
+static inline bool trace_enabled(void)
+{
+    return atomic_load_explicit(&trace_on, memory_order_relaxed);
+}
+
+/* Appends to the calling thread's ring, overwriting its oldest event once full. */
+void trace_record(trace_type_t type, int64_t ts, int task, int arg);
+
+static inline void trace_event_at(trace_type_t type, int64_t ts, int task, int arg)
+{
+    if (trace_enabled())
+        trace_record(type, ts, task, arg);
+}
+
+static inline void trace_event(trace_type_t type, int task, int arg)
+{
+    if (trace_enabled())
+        trace_record(type, clock_now_ns(), task, arg);
+}
+
+/* Drops what was recorded so far, every ring gets `capacity` events.
+   Rings of another size are replaced on their thread's next event. */
+int trace_start(int capacity);
+void trace_stop(void);
+/* Chrome trace-event JSON of every ring, -1 if the file can't be written. */
+int trace_dump(const char* path);
+
+#endif
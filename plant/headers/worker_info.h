@@ -2,19 +2,54 @@
 #define WORKER_INFO_H
 
 #include <pthread.h>
+#include <sched.h>
 #include <stdbool.h>
 #include <stdatomic.h>
 #include "../../common/plant.h"
+#include "lf_stack.h"
 #include "task_info.h"
 
-typedef struct {
+typedef enum {
+    POOL_NONE,
+    POOL_ON_SHIFT,
+    POOL_UPCOMING
+} pool_state_t;
+
+struct plant;
+
+typedef struct worker_info {
     worker_t* original_def;
+    /* Copy with every time resolved to the plant clock. */
+    worker_attr_t attr;
+    /* From `attr.cpus`, empty if the worker isn't pinned. */
+    cpu_set_t cpus;
     pthread_t thread_id;
+    /* The plant that registered the worker. */
+    struct plant* plant;
     
+    /* Guards the assignment, the manager hands tasks over under it. */
+    pthread_mutex_t lock;
     pthread_cond_t wakeup_cond;
     
     int assigned_index;
     task_info_t* assigned_task;
+
+    /* Link in the factory's stack of workers that finished a task. */
+    lf_node_t returned_node;
+    /* Link in the factory's stack of submitted workers. */
+    lf_node_t submit_node;
+
+    /* Position in the factory's idle worker pool. */
+    pool_state_t pool_state;
+    size_t pool_pos;
+    /* Station of the worker's previous task, -1 before the first one. While
+       idle on shift it is linked into the pool's list for that station. */
+    int last_station;
+    struct worker_info* station_prev;
+    struct worker_info* station_next;
+
+    /* Link in the factory's job queue, used only with pool threads. */
+    struct worker_info* next_job;
 } worker_info_t;
 
 int worker_info_init(worker_info_t* info, worker_t* worker_def);
@@ -1,20 +1,25 @@
 #ifndef WORKER_LIST_H
 #define WORKER_LIST_H
 
+#include "id_map.h"
 #include "worker_info.h"
 
 typedef struct {
     worker_info_t** items;
     size_t capacity;
     size_t count;
+    /* worker id -> worker_info_t* */
+    id_map_t index;
 
     size_t finished_workers;
 } worker_container;
 
 int worker_cont_init(worker_container* cont, size_t n_workers);
-void worker_cont_push_back(worker_container* cont, worker_info_t* worker);
+int worker_cont_push_back(worker_container* cont, worker_info_t* worker);
+void worker_cont_pop_back(worker_container* cont);
 size_t worker_cont_size(worker_container* cont);
 worker_info_t* worker_cont_get(worker_container* cont, size_t index);
+worker_info_t* worker_cont_find(worker_container* cont, int id);
 void worker_cont_free(worker_container* cont);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "worker_info.h"
+
+typedef struct {
+    worker_info_t** items;
+    size_t count;
+} worker_heap_t;
+
+/* Idle workers split by shift window. Workers on shift are kept ordered by
+   their end, so the ones leaving first are handed out (and dropped) first.
+   Workers that haven't started yet wait ordered by their start.
+   Times are nanoseconds of the plant clock. */
+typedef struct {
+    worker_heap_t on_shift;
+    worker_heap_t upcoming;
+    size_t capacity;
+
+    /* Idle workers on shift by the station they last worked at. */
+    worker_info_t** station_idle;
+    int n_stations;
+
+    /* Workers ever dropped by worker_pool_advance because their shift ended. */
+    size_t expired;
+} worker_pool_t;
+
+int worker_pool_init(worker_pool_t* pool, size_t capacity, int n_stations);
+void worker_pool_destroy(worker_pool_t* pool);
+
+/* Returns false (and doesn't store the worker) if its shift is already over. */
+bool worker_pool_put(worker_pool_t* pool, worker_info_t* w, int64_t now);
+void worker_pool_remove(worker_pool_t* pool, worker_info_t* w);
+
+/* Moves starters on shift and drops workers whose shift ended. */
+void worker_pool_advance(worker_pool_t* pool, int64_t now);
+
+/* Valid after worker_pool_advance(now). */
+size_t worker_pool_available(const worker_pool_t* pool);
+worker_info_t* worker_pool_take(worker_pool_t* pool);
+/* Prefers a worker that last worked at `station`, O(log n) either way. */
+worker_info_t* worker_pool_take_near(worker_pool_t* pool, int station);
+
+bool worker_pool_next_start(const worker_pool_t* pool, int64_t* start_ns);
+/* Earliest end of an idle worker on shift. */
+bool worker_pool_next_end(const worker_pool_t* pool, int64_t* end_ns);
+
+#endif
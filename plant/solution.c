@@ -1,520 +1,1843 @@
-#include "../common/plant.h"
-#include "headers/factory.h"
-
-#include <stdio.h>
-#include <assert.h>
-#include <time.h>
-#include <limits.h>
-#include <errno.h>
-#include <stdarg.h>
-#include <string.h>
-
-static factory_t factory;
-static pthread_mutex_t main_lock = PTHREAD_MUTEX_INITIALIZER;
-static bool manager_should_sleep = false;
-
-void syserr(const char *fmt, ...) {
-    va_list fmt_args;
-
-    va_start(fmt_args, fmt);
-    vfprintf(stderr, fmt, fmt_args);
-    va_end(fmt_args);
-
-    fprintf(stderr, "%d (%s)\n", errno, strerror(errno));
-    exit(1);
-}
-
-#define ASSERT_ZERO(expr)                                                   \
-    do {                                                                    \
-        int _rc = (expr);                                                   \
-        if (_rc != 0)                                                       \
-            syserr(                                                         \
-                "Failed: %s\n\tIn function %s() in %s line %d.\n\tError: ", \
-                #expr, __func__, __FILE__, __LINE__);                       \
-    } while (0)
-
-
-#define CLEANUP_AND_RETURN(expr)                                            \
-    do {                                                                    \    
-        int _rc = (expr);                                                   \            
-        if (_rc != 0)                                                       \
-            goto cleanup;                                                   \
-    } while (0)                                                             \
-
-void notify_manager()
-{
-    manager_should_sleep = false;
-    ASSERT_ZERO(pthread_cond_signal(&factory.manager_cond));
-}
-
-/* Function isn't thread safe, can only be done inside lock */
-bool factory_closed()
-{
-    return !factory.is_active || factory.is_terminated;
-}
-
-/* Marks the task as failed and tells the listenting thread about it if there is one.*/
-static void task_completed(task_info_t* task, bool is_failed)
-{
-    if (task->is_completed) return;
-
-    task->is_completed = true;
-    task->failed = is_failed;
-    factory.tasks.waiting_ans--;
-    ASSERT_ZERO(pthread_cond_broadcast(&task->task_complete_cond));
-
-    if (factory.is_terminated && factory.tasks.waiting_ans == 0) 
-        notify_manager();
-
-}
-
-/* Find the smallest free station that is big enough*/
-static int get_station_index(task_info_t* task)
-{
-    int workers_needed = task->original_def->capacity;
-    int best_index = -1;
-    int min_suitable_capacity = INT_MAX;
-    bool is_size_present = false;
-
-    for (size_t i = 0; i < factory.n_stations; i++) {
-        int cap = factory.station_capacity[i];
-        
-        if (cap >= workers_needed) {
-            is_size_present = true;
-
-            if (factory.station_usage[i] == 0 && cap <= min_suitable_capacity) {
-                min_suitable_capacity = cap;
-                best_index = (int)i;
-            }
-        }
-    }
-
-    if (!is_size_present)
-        task_completed(task, true);
-
-    return best_index;
-}
-
-static bool free_workers_present(task_info_t* task, const time_t now)
-{
-    int workers_needed = task->original_def->capacity;
-    int available = 0;
-    int bad_workers = 0;
-
-    time_t best = now;
-        if (best < task->original_def->start)
-            best = task->original_def->start;
-
-    /* Check for avaiable workers */
-    for (size_t i = 0; i < factory.workers.count; i++) {
-        worker_info_t* w = factory.workers.items[i];
-        
-        if (w->assigned_task == NULL && 
-            best >= w->original_def->start && 
-            best < w->original_def->end) {
-            available++;
-        }
-
-        if (available >= workers_needed) 
-            return true;
-
-        if (best >= w->original_def->end)
-            bad_workers++;
-    }
-
-    int potential_worker_size = factory.is_terminated ? 
-                                factory.workers.count : 
-                                factory.workers.capacity;
-    if ((potential_worker_size - bad_workers) < workers_needed)
-        task_completed(task, true);
-    
-    return false;
-}
-
-
-static bool worker_cond(worker_info_t* info)
-{
-    bool still_in_work = time(NULL) < info->original_def->end;
-    bool needed_at_work = 
-            (factory.is_terminated && factory.tasks.waiting_ans > 0) ||
-            !factory.is_terminated;
-
-    return still_in_work && needed_at_work;
-}
-
-static void* worker_thread_func(void* arg)
-{
-    worker_info_t* info = (worker_info_t*)arg;
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    notify_manager();
-
-    struct timespec ts;
-    ts.tv_sec = info->original_def->end;
-    ts.tv_nsec = 10000000;
-    while (worker_cond(info)) {
-        int ret;
-        while (info->assigned_task == NULL && worker_cond(info)) {
-            ret = pthread_cond_timedwait(&info->wakeup_cond, &main_lock, &ts);
-            if (ret != 0 && ret != ETIMEDOUT) 
-                syserr("Someting went wrong inside worker_tread_cond");
-        }
-
-        if (info->assigned_task == NULL) {
-            break;
-        }
-
-        task_info_t* task = info->assigned_task;
-        int my_idx = info->assigned_index;
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-        int res = info->original_def->work(info->original_def, task->original_def, my_idx);
-        task->original_def->results[my_idx] = res;
-
-        ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-        
-        task->workers_assigned--;
-        factory.station_usage[task->assigned_position]--;
-
-        if (task->workers_assigned == 0) {
-            task_completed(task, false);
-        }
-
-        info->assigned_task = NULL;
-        info->assigned_index = -1;
-        notify_manager();
-    }
-
-    time_t now = time(NULL);
-    for (int i = 0; i < factory.tasks.count; i++) {
-        task_info_t* task = factory.tasks.items[i];
-        if (task->workers_assigned > 0 || task->is_completed) continue;
-        // update the answer for workers
-        free_workers_present(task, now);
-    }
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-    return NULL;
-}
-
-static void assign_workers(const int best_ind, task_info_t* task, const time_t now)
-{   
-    int workers_needed = task->original_def->capacity;
-
-    factory.station_usage[best_ind] = workers_needed;
-    task->workers_assigned = workers_needed;
-    task->assigned_position = best_ind;
-
-    int current_worker_index = 0;
-    for (size_t i = 0; i < factory.workers.count; i++) {
-        worker_info_t* w = factory.workers.items[i];
-
-        if (w->assigned_task == NULL && now >= w->original_def->start && now < w->original_def->end) {
-            w->assigned_task = task;
-            w->assigned_index = current_worker_index;
-            ASSERT_ZERO(pthread_cond_signal(&w->wakeup_cond));
-
-            current_worker_index++;
-            if (workers_needed == current_worker_index) return;
-        }
-    }
-    syserr("Something went wrong inside assign workers, the count isn't probably well done");
-}
-
-/* Ta funkcja wydaje sie być raczej dabliu */
-static void* manager_thread_func(void* arg)
-{
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    while (!factory.is_terminated || (factory.is_terminated && factory.tasks.waiting_ans > 0)) {
-        time_t now;
-        time_t next_wakeup = 0;
-        time_t starting_time = time(NULL);
-
-        for (size_t i = 0; i < factory.tasks.count; i++) {
-            task_info_t* task = factory.tasks.items[i];
-            /* `now` update is expensive but we want to maximize the 
-               possiblity of assigning some free worker, because with `now` 
-               updating here we have smaller time windows but the throughput
-               is bigger. */
-            now = time(NULL);
-
-            if (task->is_completed || task->workers_assigned > 0) continue;
-
-            if (task->original_def->start > now) {
-                if (next_wakeup == 0 || task->original_def->start < next_wakeup) {
-                    next_wakeup = task->original_def->start;
-                }
-            }
-
-            int best_ind;
-            if (free_workers_present(task, now) && !task->is_completed &&
-               (best_ind = get_station_index(task)) != -1 && 
-                task->original_def->start <= now) {
-                assign_workers(best_ind, task, now);
-            }
-        }
-
-        /* Set next wakup for worker */
-        for (int i = 0; i < factory.workers.count; i++) {
-            worker_info_t* worker = factory.workers.items[i];
-            if (worker->original_def->start > now) {
-                if (next_wakeup == 0 || worker->original_def->start < next_wakeup) {
-                    next_wakeup = worker->original_def->start;
-                }
-            }
-        }
-
-        if (factory.is_terminated && factory.tasks.waiting_ans == 0) {
-            break;
-        }
-
-        int res = 0;
-        manager_should_sleep = true;
-        if (next_wakeup > 0 && next_wakeup > starting_time) {
-            struct timespec ts;
-            // for some reason this avoids a lot of spinning
-            ts.tv_sec = next_wakeup;
-            ts.tv_nsec = 10000000;
-            while((res == 0 && manager_should_sleep == true)) {
-                res = pthread_cond_timedwait(&factory.manager_cond, &main_lock, &ts);
-                if (res != 0 && res != ETIMEDOUT) syserr("pthread condition unexpected finish");
-            }
-        } else {
-            while(manager_should_sleep) {
-                ASSERT_ZERO(pthread_cond_wait(&factory.manager_cond, &main_lock));
-            }
-        }
-    }
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-    return NULL;
-}
-
-/* Function initializes factory if it hasn't been initialized before.
-   Does memory allocation before entering mutex for efficiency */
-int init_plant(int* stations, int n_stations, int n_workers)
-{
-    int level = 0;
-    factory_t f = {0};
-
-    CLEANUP_AND_RETURN(factory_init(&f, n_stations, stations, n_workers));
-    level++;
-
-    /* Now we enter mutex end check if we can still initialize factory */
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    CLEANUP_AND_RETURN(factory.is_active);
-    level++;
-
-    factory = f;
-
-    /* We need to remember to destroy the condition when leaving mutex. */
-    CLEANUP_AND_RETURN(pthread_cond_init(&factory.manager_cond, NULL));
-    level++;
-
-    CLEANUP_AND_RETURN(pthread_create(&factory.manager_thread, NULL, manager_thread_func, NULL));
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-    return PLANTOK;
-
-    cleanup:
-        switch (level)
-        {
-            case 3:
-                ASSERT_ZERO(pthread_cond_destroy(&factory.manager_cond));
-            case 2:
-                factory_destroy(&factory);
-                ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-                break;
-            case 1:
-                ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-                factory_destroy(&f);
-            default:
-                break;
-        }
-    return ERROR;
-}
-
-/* We terminate the whole plantation and wait for it to handle all tasks,
-   that run currently. */
-int destroy_plant()
-{
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    if (factory_closed()) {
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        return ERROR;
-    }
-
-    factory.is_terminated = true;
-    notify_manager();
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    ASSERT_ZERO(pthread_join(factory.manager_thread, NULL));
-
-    /* After manager left we signall all remaining 
-       workers so they can leave */
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-    int size = worker_cont_size(&factory.workers);
-    for (size_t i = 0; i < size; i++) {
-        worker_info_t* w = factory.workers.items[i];
-        ASSERT_ZERO(pthread_cond_signal(&w->wakeup_cond));
-    }
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    for (size_t i = 0; i < factory.workers.count; i++) {
-        worker_info_t* w = factory.workers.items[i];
-        ASSERT_ZERO(pthread_join(w->thread_id, NULL));
-    }
-
-
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    factory_destroy(&factory);
-    ASSERT_ZERO(pthread_cond_destroy(&factory.manager_cond));
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    return PLANTOK;
-}
-
-int add_worker(worker_t* w)
-{
-    if (!w) {
-        return ERROR;
-    }
-
-    worker_info_t* wrapper = calloc(1,sizeof(worker_info_t));
-    if (!wrapper) return ERROR;
-
-    if (worker_info_init(wrapper, w) != 0) {
-        free(wrapper);
-        return ERROR;
-    }
-
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    if (factory_closed()) {
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        worker_info_destroy(wrapper);
-        free(wrapper);
-        return ERROR;
-    }
-
-    int prev_size = factory.workers.count;
-    worker_cont_push_back(&factory.workers, wrapper);
-    int cur_size = factory.workers.count;
-
-    if(prev_size != cur_size && 
-        pthread_create(&wrapper->thread_id, NULL, worker_thread_func, wrapper) != 0) {
-        worker_info_destroy(wrapper);
-        free(wrapper);
-        factory.workers.count--;
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        return ERROR;
-    }
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    return PLANTOK;
-}
-
-int add_task(task_t* t)
-{
-    if (!t) {
-        return ERROR;
-    }
-
-    task_info_t* wrapper = calloc(1, sizeof(task_info_t));
-    if(!wrapper) return ERROR;
-
-    if (task_info_init(wrapper, t) != 0) {
-        free(wrapper);
-        return ERROR;
-    }
-
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    if (factory_closed()) {
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        task_info_destroy(wrapper);
-        free(wrapper);
-        return ERROR;
-    }
-
-    int prev_size = factory.tasks.count;
-    int ret = task_cont_push_back(&factory.tasks, wrapper);
-    int cur_size = factory.tasks.count;
-
-    if (ret != 0) {
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        task_info_destroy(wrapper);
-        free(wrapper);
-        return ERROR;
-    }
-
-    /* If we really added a new element tell manager about the update. */
-    if (prev_size != cur_size) {
-        /* This way we check if the task can fail*/
-        factory.tasks.waiting_ans++;
-        get_station_index(wrapper);
-        if (!wrapper->is_completed)
-            free_workers_present(wrapper, wrapper->original_def->start);
-        /* If we didn't fail we can notify manager about new task*/
-        if (!wrapper->failed)notify_manager();
-    }
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    return PLANTOK;
-}
-
-static bool can_be_collected(task_t *t, task_info_t** wrapper)
-{
-    for (size_t i = 0; i < factory.tasks.count; i++) {
-        task_info_t* cur_task = factory.tasks.items[i];
-        
-        if (cur_task->original_def->id == t->id) {
-            *wrapper = cur_task;
-            break;
-        }
-    }
-    if (*wrapper == NULL) {
-        return false;
-    }
-    return true;
-}
-
-int collect_task(task_t* t)
-{
-    if (!t)
-        return ERROR;
-    
-    task_info_t* wrapper = NULL;
-
-    ASSERT_ZERO(pthread_mutex_lock(&main_lock));
-
-    if (factory_closed() || 
-        !can_be_collected(t, &wrapper)) {
-        ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-        return ERROR;
-    }
-    
-    factory.tasks.waiting_ans++;
-    while (!wrapper->is_completed) {
-        ASSERT_ZERO(pthread_cond_wait(&wrapper->task_complete_cond, &main_lock));
-    }
-    factory.tasks.waiting_ans--;
-    /* We need to read here because destroy may be called. */
-    bool bad = wrapper->failed;
-
-    if (factory.is_terminated && factory.tasks.waiting_ans == 0)
-        notify_manager();
-
-    ASSERT_ZERO(pthread_mutex_unlock(&main_lock));
-
-    if (bad) return ERROR;
-    return PLANTOK;
+#include "../common/plant.h"
+#include "headers/factory.h"
+#include "headers/futex.h"
+#include "headers/plant_clock.h"
+#include "headers/trace.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include <limits.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* Everything one plant needs. Only `factory` is replaced by init, the locks
+   live as long as the plant, so the default plant can be a static one.
+   Lock order: main_lock, then a worker's own lock. The wake and jobs
+   locks are never held while taking another one. */
+struct plant {
+    pthread_mutex_t main_lock;
+    pthread_mutex_t wake_lock;
+    pthread_mutex_t jobs_lock;
+    bool manager_should_sleep;
+    /* Threads inside add_task or add_worker past their closed check. */
+    atomic_int submitters;
+    /* Set by init once the factory is built, cleared by shutdown. The
+       submitters check it instead of the factory, which init overwrites. */
+    atomic_bool accepting;
+    /* Batch collectors waiting for any of their tasks, woken by every completion. */
+    pthread_mutex_t any_lock;
+    pthread_cond_t any_cond;
+    atomic_int any_waiters;
+
+    factory_t factory;
+};
+
+/* The plant behind init_plant() and the other functions without a handle. */
+static plant_t default_plant = {
+    .main_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake_lock = PTHREAD_MUTEX_INITIALIZER,
+    .jobs_lock = PTHREAD_MUTEX_INITIALIZER,
+    .any_lock = PTHREAD_MUTEX_INITIALIZER,
+    .any_cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* A task handed over by add_task, registered later under main_lock. */
+typedef struct {
+    lf_node_t node;
+    task_t* def;
+    task_attr_t attr;
+} task_submission_t;
+
+void syserr(const char *fmt, ...) {
+    va_list fmt_args;
+
+    va_start(fmt_args, fmt);
+    vfprintf(stderr, fmt, fmt_args);
+    va_end(fmt_args);
+
+    fprintf(stderr, "%d (%s)\n", errno, strerror(errno));
+    exit(1);
+}
+
+#define ASSERT_ZERO(expr)                                                   \
+    do {                                                                    \
+        int _rc = (expr);                                                   \
+        if (_rc != 0)                                                       \
+            syserr(                                                         \
+                "Failed: %s\n\tIn function %s() in %s line %d.\n\tError: ", \
+                #expr, __func__, __FILE__, __LINE__);                       \
+    } while (0)
+
+
+#define CLEANUP_AND_RETURN(expr)                                            \
+    do {                                                                    \
+        int _rc = (expr);                                                   \
+        if (_rc != 0)                                                       \
+            goto cleanup;                                                   \
+    } while (0)                                                             \
+
+/* Takes main_lock, counting the time spent waiting for it. */
+static void lock_main(plant_t* p)
+{
+    int rc = pthread_mutex_trylock(&p->main_lock);
+    if (rc == 0)
+        return;
+    if (rc != EBUSY)
+        syserr("Failed to lock main_lock");
+
+    int64_t from = clock_now_ns();
+    ASSERT_ZERO(pthread_mutex_lock(&p->main_lock));
+    stats_add(&p->factory.stats, STAT_MAIN_LOCK_WAIT_NS, clock_now_ns() - from);
+}
+
+/* Safe to call without main_lock, the manager sleeps under wake_lock. */
+static void notify_manager(plant_t* p)
+{
+    ASSERT_ZERO(pthread_mutex_lock(&p->wake_lock));
+    p->manager_should_sleep = false;
+    ASSERT_ZERO(pthread_cond_signal(&p->factory.manager_cond));
+    ASSERT_ZERO(pthread_mutex_unlock(&p->wake_lock));
+}
+
+/* Safe outside lock, but only stays true after the check inside it. */
+static bool factory_closed(plant_t* p)
+{
+    return !p->factory.is_active || p->factory.is_terminated;
+}
+
+/* Lets add_task and add_worker push without main_lock. destroy_plant
+   waits for the threads inside before it registers the last submissions,
+   and seeing `accepting` set means the factory's init is seen too. */
+static bool submission_begin(plant_t* p)
+{
+    p->submitters++;
+    if (!atomic_load(&p->accepting)) {
+        p->submitters--;
+        return false;
+    }
+    return true;
+}
+
+static void submission_end(plant_t* p)
+{
+    p->submitters--;
+}
+
+/* Hands a completed task over to its asynchronous collector. The task
+   may be retired as soon as it is pushed. */
+static void deliver_async(plant_t* p, task_info_t* task)
+{
+    if (task->callback != NULL) {
+        lf_stack_push(&p->factory.async_callbacks, &task->async_node);
+        notify_manager(p);
+    } else if (lf_stack_push(&p->factory.async_drain, &task->async_node)) {
+        uint64_t one = 1;
+        if (write(p->factory.completion_fd, &one, sizeof(one)) != sizeof(one))
+            syserr("Failed to signal the completion eventfd");
+    }
+}
+
+/* Wakes the collectors of the task, without taking any lock. */
+static void publish_completion(plant_t* p, task_info_t* task, bool is_failed)
+{
+    task->failed = is_failed;
+    stats_add(&p->factory.stats, is_failed ? STAT_TASKS_INFEASIBLE : STAT_TASKS_COMPLETED, 1);
+    trace_event(TRACE_COMPLETED, task->original_def->id, is_failed);
+    /* A collector that sees TASK_DONE may retire the task right away, but
+       the info outlives the wake while we count as its publisher. */
+    atomic_fetch_add_explicit(&task->publishers, 1, memory_order_relaxed);
+    unsigned old = atomic_fetch_or(&task->completion, TASK_DONE);
+    if (old & TASK_WAITERS)
+        futex_wake_all(&task->completion);
+    atomic_fetch_sub_explicit(&task->publishers, 1, memory_order_release);
+    /* Either we see the asynchronous collector or it sees TASK_DONE. An
+       asynchronous one keeps the task until its delivery is taken over. */
+    if (old & TASK_ASYNC)
+        deliver_async(p, task);
+
+    if (p->any_waiters > 0) {
+        ASSERT_ZERO(pthread_mutex_lock(&p->any_lock));
+        ASSERT_ZERO(pthread_cond_broadcast(&p->any_cond));
+        ASSERT_ZERO(pthread_mutex_unlock(&p->any_lock));
+    }
+
+    if (--p->factory.tasks.waiting_ans == 0 && p->factory.is_terminated)
+        notify_manager(p);
+}
+
+/* Marks the task as failed and tells the listenting thread about it if there is one.
+   Done inside lock, for tasks that didn't get any workers. */
+static void task_completed(plant_t* p, task_info_t* task, bool is_failed)
+{
+    if (task_info_completed(task)) return;
+
+    if (task->sched == SCHED_START_HEAP)
+        task_heap_remove(&p->factory.start_heap, task);
+    publish_completion(p, task, is_failed);
+}
+
+/* Once a completed task has been collected (or can't be anymore, because
+   the plant is terminating) it is dropped from the factory and its info
+   goes back to the free list. The caller mustn't touch `task` afterwards. */
+static void retire_task(plant_t* p, task_info_t* task)
+{
+    if (!task_info_completed(task) || task->collectors > 0 || task->sched != SCHED_NONE ||
+        task->pending_release)
+        return;
+    if (!task->collected && !p->factory.is_terminated)
+        return;
+
+    task_cont_remove(&p->factory.tasks, task);
+    task_cont_recycle(&p->factory.tasks, task);
+}
+
+/* Fails the task if no station is ever big enough for it. */
+static bool station_fits(plant_t* p, task_info_t* task)
+{
+    if (station_index_fits(&p->factory.stations, task_info_min_workers(task)))
+        return true;
+
+    task_completed(p, task, true);
+    return false;
+}
+
+/* False if starting the task with `workers` on `station` would delay the reserved one. */
+static bool backfill_admits(plant_t* p, task_info_t* task, int station, int workers, const int64_t now)
+{
+    return station != -1 &&
+           backfill_allows(&p->factory.backfill, task, workers, p->factory.station_capacity[station], now);
+}
+
+/* Take the smallest free station that is big enough for as many workers as the
+   task can get now, at least its minimum. If backfilling keeps the task off that
+   station, a moldable task may still start with fewer workers on a smaller one.
+   The number of workers goes to `n_workers`. */
+static int get_station_index(plant_t* p, task_info_t* task, int* n_workers, const int64_t now)
+{
+    int wanted = task->original_def->capacity;
+    int available = (int)worker_pool_available(&p->factory.idle_workers);
+    int largest = station_index_max_free(&p->factory.stations);
+    if (wanted > available)
+        wanted = available;
+    if (wanted > largest)
+        wanted = largest;
+    if (wanted < task_info_min_workers(task))
+        return -1;
+
+    int station = station_index_peek(&p->factory.stations, wanted);
+    if (!backfill_admits(p, task, station, wanted, now)) {
+        station = station_index_peek(&p->factory.stations, task_info_min_workers(task));
+        if (station != -1 && wanted > p->factory.station_capacity[station])
+            wanted = p->factory.station_capacity[station];
+        if (!backfill_admits(p, task, station, wanted, now))
+            return -1;
+    }
+
+    /* The smallest free station fitting `wanted` is the one checked. */
+    *n_workers = wanted;
+    return station_index_acquire(&p->factory.stations, wanted);
+}
+
+/* Workers that may still work at `t`: registered ones whose shift isn't
+   over by then and, before termination, the ones that may still be added. */
+static int workers_left_at(plant_t* p, const int64_t t)
+{
+    int potential_worker_size = p->factory.is_terminated ?
+                                p->factory.workers.count :
+                                p->factory.workers.capacity;
+    return potential_worker_size - (int)shift_index_ended_by(&p->factory.shift_ends, t);
+}
+
+static bool free_workers_present(plant_t* p, task_info_t* task, const int64_t now)
+{
+    int workers_needed = task_info_min_workers(task);
+
+    int64_t best = now;
+        if (best < task->attr.start_ns)
+            best = task->attr.start_ns;
+
+    /* Check for avaiable workers, only idle workers on shift are in the pool */
+    if (best == now) {
+        worker_pool_advance(&p->factory.idle_workers, now);
+        if (worker_pool_available(&p->factory.idle_workers) >= workers_needed)
+            return true;
+    }
+
+    if (workers_left_at(p, best) < workers_needed)
+        task_completed(p, task, true);
+    
+    return false;
+}
+
+
+/* Fails every waiting task that can't get enough workers anymore.
+   Needed when the plant terminates, shifts ending are handled by
+   fail_infeasible_ready_tasks(). */
+static void recheck_waiting_tasks(plant_t* p)
+{
+    int64_t now = clock_now_ns();
+    for (int i = 0; i < p->factory.tasks.count; i++) {
+        task_info_t* task = p->factory.tasks.items[i];
+        if (task->workers_assigned > 0 || task_info_completed(task)) continue;
+        // update the answer for workers
+        free_workers_present(p, task, now);
+    }
+}
+
+static bool worker_cond(plant_t* p, worker_info_t* info)
+{
+    bool still_in_work = clock_now_ns() < info->attr.end_ns;
+    bool needed_at_work = 
+            (p->factory.is_terminated && p->factory.tasks.waiting_ans > 0) ||
+            !p->factory.is_terminated;
+
+    return still_in_work && needed_at_work;
+}
+
+/* CPUs for the worker's part of the task: its station's, else its own. */
+static const cpu_set_t* work_cpus(plant_t* p, worker_info_t* info, task_info_t* task)
+{
+    if (p->factory.station_cpus != NULL &&
+        affinity_pinned(&p->factory.station_cpus[task->assigned_position]))
+        return &p->factory.station_cpus[task->assigned_position];
+    if (affinity_pinned(&info->cpus))
+        return &info->cpus;
+    return NULL;
+}
+
+/* Moves the calling thread only if the work wants other CPUs than its
+   previous work did. An empty `bound` stands for the plant's CPUs. */
+static void bind_thread(plant_t* p, cpu_set_t* bound, const cpu_set_t* wanted)
+{
+    if (wanted == NULL) {
+        if (affinity_pinned(bound)) {
+            affinity_apply(&p->factory.all_cpus);
+            CPU_ZERO(bound);
+        }
+    } else if (!CPU_EQUAL(bound, wanted)) {
+        affinity_apply(wanted);
+        *bound = *wanted;
+    }
+}
+
+/* The worker's contiguous range of the task's `n_items`, the ranges of its
+   workers differ by one item at most. */
+static void worker_range(const task_info_t* task, int my_idx, int64_t n_items, int* from, int* to)
+{
+    *from = (int)(my_idx * n_items / task->n_workers);
+    *to = (int)((my_idx + 1) * n_items / task->n_workers);
+}
+
+/* Runs the worker's part of the task, without holding the lock.
+   `bound` keeps the CPUs of the calling thread between its tasks.
+   Returns when the work ended. */
+static int64_t perform_work(plant_t* p, worker_info_t* info, task_info_t* task, int my_idx,
+                            cpu_set_t* bound)
+{
+    bind_thread(p, bound, work_cpus(p, info, task));
+    int64_t from = clock_now_ns();
+    trace_event_at(TRACE_WORK_BEGIN, from, task->original_def->id, info->original_def->id);
+    int first, last;
+    if (task->attr.batch_function != NULL) {
+        int64_t n_items = task->attr.n_items > 0 ? task->attr.n_items : task->original_def->capacity;
+        worker_range(task, my_idx, n_items, &first, &last);
+        if (last > first)
+            task->attr.batch_function(task->original_def->data + first,
+                                      task->original_def->results + first, last - first);
+    } else {
+        /* A single index, unless a moldable task started with fewer workers. */
+        worker_range(task, my_idx, task->original_def->capacity, &first, &last);
+        for (int i = first; i < last; i++) {
+            int res = info->original_def->work(info->original_def, task->original_def, i);
+            if (task->staging)
+                task->slots[i].value = res;
+            else
+                task->original_def->results[i] = res;
+        }
+    }
+    int64_t to = clock_now_ns();
+    trace_event_at(TRACE_WORK_END, to, task->original_def->id, info->original_def->id);
+    stats_add(&p->factory.stats, STAT_WORKER_BUSY_NS, to - from);
+    return to;
+}
+
+/* Bookkeeping after the worker finished its part, done without main_lock.
+   The last worker of a task completes it, the station and the workers are
+   handed back to the manager through the lock-free stacks. */
+static void finish_work(plant_t* p, worker_info_t* info, task_info_t* task, int64_t now)
+{
+    ASSERT_ZERO(pthread_mutex_lock(&info->lock));
+    info->assigned_task = NULL;
+    info->assigned_index = -1;
+    ASSERT_ZERO(pthread_mutex_unlock(&info->lock));
+
+    --p->factory.station_usage[task->assigned_position];
+    if (--task->workers_assigned == 0) {
+        /* The decrements order the other workers' slot writes before this. */
+        if (task->staging)
+            task_info_gather_results(task);
+        stats_add(&p->factory.stats, STAT_STATION_BUSY_NS, now - task->started_ns);
+        /* Queued before publishing, so a collector that saw the result
+           finds the task on the stack when it takes main_lock. */
+        task->pending_release = true;
+        lf_stack_push(&p->factory.finished_tasks, &task->finished_node);
+        publish_completion(p, task, false);
+    }
+
+    lf_stack_push(&p->factory.returned_workers, &info->returned_node);
+    notify_manager(p);
+}
+
+/* Takes over what the workers handed back: frees the stations of finished
+   tasks, retires them and puts the workers back into the idle pool.
+   Done inside lock. */
+static void collect_finished_work(plant_t* p)
+{
+    lf_node_t* node = lf_stack_take_all(&p->factory.finished_tasks);
+    while (node != NULL) {
+        task_info_t* task = LF_CONTAINER_OF(node, task_info_t, finished_node);
+        node = node->next;
+
+        station_index_release(&p->factory.stations, task->assigned_position);
+        p->factory.station_task[task->assigned_position] = NULL;
+        if (p->factory.backfill_enabled)
+            backfill_remove_running(&p->factory.backfill, task->assigned_position);
+        task->pending_release = false;
+        /* Its last worker may still be publishing the result, only
+           a collector that got the result knows it is done with it. */
+        if (task->collected)
+            retire_task(p, task);
+    }
+
+    bool worker_left = false;
+    int64_t now = clock_now_ns();
+    node = lf_stack_take_all(&p->factory.returned_workers);
+    while (node != NULL) {
+        worker_info_t* info = LF_CONTAINER_OF(node, worker_info_t, returned_node);
+        node = node->next;
+
+        if (!worker_pool_put(&p->factory.idle_workers, info, now))
+            worker_left = true;
+    }
+
+    /* A worker thread reports when it leaves, pool workers don't have one. */
+    if (worker_left && p->factory.n_pool_threads > 0)
+        p->factory.shifts_ended = true;
+}
+
+/* Called with the worker's lock held, which is dropped while taking main_lock.
+   The worker leaves the idle pool for good unless the manager assigned it
+   a task meanwhile or it is needed again, because tasks submitted before
+   termination were registered after the worker thread started. Then false
+   is returned with the worker's lock held again. */
+static bool worker_leave(plant_t* p, worker_info_t* info)
+{
+    ASSERT_ZERO(pthread_mutex_unlock(&info->lock));
+    lock_main(p);
+
+    /* Our own return may still be queued, it must not outlive the thread. */
+    collect_finished_work(p);
+
+    ASSERT_ZERO(pthread_mutex_lock(&info->lock));
+    if (info->assigned_task != NULL || worker_cond(p, info)) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return false;
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&info->lock));
+
+    worker_pool_remove(&p->factory.idle_workers, info);
+    /* The manager rechecks once for every thread leaving meanwhile. */
+    p->factory.shifts_ended = true;
+    notify_manager(p);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return true;
+}
+
+static void* worker_thread_func(void* arg)
+{
+    worker_info_t* info = (worker_info_t*)arg;
+    plant_t* p = info->plant;
+    notify_manager(p);
+
+    ASSERT_ZERO(pthread_mutex_lock(&info->lock));
+
+    struct timespec ts = clock_to_timespec(info->attr.end_ns);
+    cpu_set_t bound;
+    CPU_ZERO(&bound);
+    while (true) {
+        int ret;
+        int64_t idle_from = clock_now_ns();
+        while (info->assigned_task == NULL && worker_cond(p, info)) {
+            ret = pthread_cond_timedwait(&info->wakeup_cond, &info->lock, &ts);
+            if (ret != 0 && ret != ETIMEDOUT) 
+                syserr("Someting went wrong inside worker_tread_cond");
+        }
+        stats_add(&p->factory.stats, STAT_WORKER_IDLE_NS, clock_now_ns() - idle_from);
+
+        /* A task handed over right at the end of the shift is still done. */
+        if (info->assigned_task == NULL) {
+            if (worker_leave(p, info))
+                break;
+            continue;
+        }
+
+        task_info_t* task = info->assigned_task;
+        int my_idx = info->assigned_index;
+        ASSERT_ZERO(pthread_mutex_unlock(&info->lock));
+
+        int64_t done = perform_work(p, info, task, my_idx, &bound);
+        finish_work(p, info, task, done);
+
+        ASSERT_ZERO(pthread_mutex_lock(&info->lock));
+    }
+
+    return NULL;
+}
+
+/* Pool threads take queued jobs of any worker. A worker whose shift ended
+   during the job doesn't go back to the idle pool. */
+static void* pool_thread_func(void* arg)
+{
+    plant_t* p = arg;
+    cpu_set_t bound;
+    CPU_ZERO(&bound);
+    ASSERT_ZERO(pthread_mutex_lock(&p->jobs_lock));
+
+    while (true) {
+        int64_t idle_from = clock_now_ns();
+        while (job_queue_empty(&p->factory.jobs) && !p->factory.pool_stopping) {
+            ASSERT_ZERO(pthread_cond_wait(&p->factory.jobs_cond, &p->jobs_lock));
+        }
+        stats_add(&p->factory.stats, STAT_WORKER_IDLE_NS, clock_now_ns() - idle_from);
+
+        worker_info_t* info = job_queue_pop(&p->factory.jobs);
+        if (info == NULL)
+            break;
+        ASSERT_ZERO(pthread_mutex_unlock(&p->jobs_lock));
+
+        ASSERT_ZERO(pthread_mutex_lock(&info->lock));
+        task_info_t* task = info->assigned_task;
+        int my_idx = info->assigned_index;
+        ASSERT_ZERO(pthread_mutex_unlock(&info->lock));
+
+        int64_t done = perform_work(p, info, task, my_idx, &bound);
+        finish_work(p, info, task, done);
+
+        ASSERT_ZERO(pthread_mutex_lock(&p->jobs_lock));
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->jobs_lock));
+    return NULL;
+}
+
+/* Pool threads only ever take jobs_lock, so this may be called with main_lock held. */
+static void stop_pool_threads(plant_t* p, int n_started)
+{
+    ASSERT_ZERO(pthread_mutex_lock(&p->jobs_lock));
+    p->factory.pool_stopping = true;
+    ASSERT_ZERO(pthread_cond_broadcast(&p->factory.jobs_cond));
+    ASSERT_ZERO(pthread_mutex_unlock(&p->jobs_lock));
+
+    for (int i = 0; i < n_started; i++) {
+        ASSERT_ZERO(pthread_join(p->factory.pool_threads[i], NULL));
+    }
+}
+
+/* Called with main_lock held. Either all threads start or none is left running. */
+static int start_pool_threads(plant_t* p)
+{
+    for (int i = 0; i < p->factory.n_pool_threads; i++) {
+        if (pthread_create(&p->factory.pool_threads[i], NULL, pool_thread_func, p) != 0) {
+            stop_pool_threads(p, i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void assign_workers(plant_t* p, const int best_ind, task_info_t* task, const int workers_needed,
+                           const int64_t now)
+{
+    p->factory.station_usage[best_ind] = workers_needed;
+    p->factory.station_task[best_ind] = task;
+    task->n_workers = workers_needed;
+    task->workers_assigned = workers_needed;
+    task->assigned_position = best_ind;
+    task->started_ns = now;
+    stats_add(&p->factory.stats, STAT_TASKS_STARTED, 1);
+    trace_event(TRACE_ASSIGN, task->original_def->id, best_ind);
+
+    worker_pool_advance(&p->factory.idle_workers, now);
+    if (worker_pool_available(&p->factory.idle_workers) < workers_needed)
+        syserr("Something went wrong inside assign workers, the count isn't probably well done");
+
+    for (int i = 0; i < workers_needed; i++) {
+        worker_info_t* w = p->factory.sticky_workers ?
+                           worker_pool_take_near(&p->factory.idle_workers, best_ind) :
+                           worker_pool_take(&p->factory.idle_workers);
+        w->last_station = best_ind;
+        ASSERT_ZERO(pthread_mutex_lock(&w->lock));
+        w->assigned_task = task;
+        w->assigned_index = i;
+        if (p->factory.n_pool_threads == 0)
+            ASSERT_ZERO(pthread_cond_signal(&w->wakeup_cond));
+        ASSERT_ZERO(pthread_mutex_unlock(&w->lock));
+
+        if (p->factory.n_pool_threads > 0) {
+            ASSERT_ZERO(pthread_mutex_lock(&p->jobs_lock));
+            job_queue_push(&p->factory.jobs, w);
+            ASSERT_ZERO(pthread_cond_signal(&p->factory.jobs_cond));
+            ASSERT_ZERO(pthread_mutex_unlock(&p->jobs_lock));
+        }
+    }
+}
+
+/* Whether backfilling should rather reserve for `task` than for `widest`.
+   Ties go to the task that is first in the plant's order. */
+static bool reserves_before(plant_t* p, task_info_t* task, task_info_t* widest)
+{
+    int needed = task_info_min_workers(task);
+    return widest == NULL || needed > task_info_min_workers(widest) ||
+           (p->factory.priority_order && needed == task_info_min_workers(widest) &&
+            task_heap_by_priority(task, widest));
+}
+
+/* The task left the ready set, if it was the one reserved for the next
+   reservation has to search again. */
+static void ready_task_left(plant_t* p, task_info_t* task)
+{
+    if (task == p->factory.backfill_widest) {
+        p->factory.backfill_widest = NULL;
+        p->factory.backfill_widest_stale = true;
+    }
+}
+
+/* Adds a task whose `start` has come to the ready set of the plant's order. */
+static void push_ready_task(plant_t* p, task_info_t* task)
+{
+    int res = p->factory.priority_order ?
+              task_heap_push(&p->factory.ready_heap, task) :
+              task_queue_push(&p->factory.ready_tasks, task);
+    if (res != 0) {
+        task_completed(p, task, true);
+        ready_task_left(p, task);
+        return;
+    }
+
+    /* Tasks no station fits fail when they are tried. */
+    if (p->factory.backfill_enabled && task != p->factory.backfill_widest &&
+        station_index_fits(&p->factory.stations, task_info_min_workers(task)) &&
+        reserves_before(p, task, p->factory.backfill_widest))
+        p->factory.backfill_widest = task;
+}
+
+/* Moves tasks whose `start` has come from the heap to the ready set,
+   failing the ones that can't get enough workers anymore. */
+static void release_started_tasks(plant_t* p, const int64_t now)
+{
+    task_info_t* task;
+    int examined = 0;
+    int workers_left = -1;
+    while ((task = task_heap_top(&p->factory.start_heap)) != NULL &&
+           task->attr.start_ns <= now) {
+        task_heap_pop(&p->factory.start_heap);
+        examined++;
+
+        int needed = task_info_min_workers(task);
+        if (workers_left == -1)
+            workers_left = workers_left_at(p, now);
+        if (needed > workers_left) {
+            task_completed(p, task, true);
+            retire_task(p, task);
+            continue;
+        }
+        if (needed > p->factory.ready_widest)
+            p->factory.ready_widest = needed;
+        push_ready_task(p, task);
+    }
+    stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, examined);
+}
+
+/* Ending shifts don't change what tasks that haven't started yet were
+   checked against, the shifts over by their start. Only ready tasks wider
+   than the workers left now can have become infeasible, so the ready set
+   is only walked if the widest of them is. */
+static void fail_infeasible_ready_tasks(plant_t* p, const int64_t now)
+{
+    int workers_left = workers_left_at(p, now);
+    if (p->factory.ready_widest <= workers_left)
+        return;
+
+    int widest = 0;
+    size_t n_ready = p->factory.priority_order ? p->factory.ready_heap.count :
+                                                 task_queue_size(&p->factory.ready_tasks);
+    stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, n_ready);
+    for (size_t i = 0; i < n_ready; i++) {
+        task_info_t* task = p->factory.priority_order ? p->factory.ready_heap.items[i] :
+                                                        task_queue_at(&p->factory.ready_tasks, i);
+        int needed = task_info_min_workers(task);
+        if (task_info_completed(task))
+            continue;
+        if (needed > workers_left)
+            task_completed(p, task, true);
+        else if (needed > widest)
+            widest = needed;
+    }
+    p->factory.ready_widest = widest;
+    if (p->factory.backfill_widest != NULL && task_info_completed(p->factory.backfill_widest))
+        ready_task_left(p, p->factory.backfill_widest);
+
+    /* Out of the ready set, so collecting a failed task retires it and its id is free again. */
+    if (p->factory.priority_order)
+        task_heap_remove_completed(&p->factory.ready_heap);
+    else
+        task_queue_remove_completed(&p->factory.ready_tasks);
+}
+
+/* A registered worker adds a shift end, which can make tasks that haven't
+   started infeasible by their start. The start heap is only walked if its
+   widest task wouldn't fit once every registered shift is over. */
+static void fail_infeasible_pending_tasks(plant_t* p)
+{
+    if (p->factory.pending_widest <= workers_left_at(p, INT64_MAX))
+        return;
+
+    task_heap_t* heap = &p->factory.start_heap;
+    int widest = 0;
+    bool failed = false;
+    stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, heap->count);
+    for (size_t i = 0; i < heap->count; i++) {
+        task_info_t* task = heap->items[i];
+        int needed = task_info_min_workers(task);
+        /* Published in place and removed after the walk. */
+        if (needed > workers_left_at(p, task->attr.start_ns)) {
+            publish_completion(p, task, true);
+            failed = true;
+        } else if (needed > widest) {
+            widest = needed;
+        }
+    }
+    p->factory.pending_widest = widest;
+
+    if (failed)
+        task_heap_remove_completed(heap);
+}
+
+/* Walks the ready set for the task to reserve for, only after the last one left. */
+static task_info_t* find_widest_ready_task(plant_t* p)
+{
+    task_info_t* widest = NULL;
+    size_t n_ready = p->factory.priority_order ? p->factory.ready_heap.count :
+                                                 task_queue_size(&p->factory.ready_tasks);
+    stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, n_ready);
+    for (size_t i = 0; i < n_ready; i++) {
+        task_info_t* task = p->factory.priority_order ? p->factory.ready_heap.items[i] :
+                                                        task_queue_at(&p->factory.ready_tasks, i);
+        if (task_info_completed(task) ||
+            !station_index_fits(&p->factory.stations, task_info_min_workers(task)))
+            continue;
+        if (reserves_before(p, task, widest))
+            widest = task;
+    }
+    return widest;
+}
+
+/* Reserves what the widest ready task needs for the rest of the pass. */
+static void reserve_widest_task(plant_t* p, const int64_t now)
+{
+    backfill_t* b = &p->factory.backfill;
+    backfill_clear(b);
+
+    if (p->factory.backfill_widest_stale) {
+        p->factory.backfill_widest = find_widest_ready_task(p);
+        p->factory.backfill_widest_stale = false;
+    }
+    task_info_t* widest = p->factory.backfill_widest;
+    /* Failed at termination, it leaves the ready set once tried. */
+    if (widest == NULL || task_info_completed(widest))
+        return;
+
+    size_t n_starts;
+    const int64_t* starts = shift_index_after(&p->factory.shift_starts, now, &n_starts);
+    int needed = task_info_min_workers(widest);
+    backfill_reserve(b, widest, worker_pool_available(&p->factory.idle_workers),
+                     station_index_free_fitting(&p->factory.stations, needed), starts, n_starts, now);
+}
+
+/* Starts a ready task if it can, true if the task left the ready set. */
+static bool try_start_task(plant_t* p, task_info_t* task, const int64_t now)
+{
+    int best_ind, n_workers;
+    if (!task_info_completed(task) && free_workers_present(p, task, now) &&
+        station_fits(p, task) &&
+       (best_ind = get_station_index(p, task, &n_workers, now)) != -1) {
+        assign_workers(p, best_ind, task, n_workers, now);
+        if (p->factory.backfill_enabled) {
+            int64_t end = task->attr.expected_ns > 0 ? now + task->attr.expected_ns : BACKFILL_UNKNOWN;
+            backfill_add_running(&p->factory.backfill, best_ind, end, n_workers,
+                                 p->factory.station_capacity[best_ind]);
+            backfill_started(&p->factory.backfill, task, p->factory.station_capacity[best_ind], now);
+        }
+        ready_task_left(p, task);
+        return true;
+    }
+
+    if (!task_info_completed(task))
+        return false;
+
+    backfill_forget(&p->factory.backfill, task);
+    ready_task_left(p, task);
+    retire_task(p, task);
+    return true;
+}
+
+/* True while an idle worker and a free station are left. */
+static bool can_start_more(plant_t* p)
+{
+    return worker_pool_available(&p->factory.idle_workers) > 0 &&
+           station_index_free_count(&p->factory.stations) > 0;
+}
+
+/* Tries the ready tasks in the plant's order while something can still
+   start, so a pass costs what it starts, not how many tasks wait. */
+static void schedule_ready_tasks(plant_t* p, const int64_t now)
+{
+    worker_pool_advance(&p->factory.idle_workers, now);
+    if (!can_start_more(p))
+        return;
+    if (p->factory.backfill_enabled)
+        reserve_widest_task(p, now);
+
+    if (!p->factory.priority_order) {
+        task_queue_t* ready = &p->factory.ready_tasks;
+        size_t tried = 0;
+        /* Tasks that still wait keep their place in the queue. */
+        while (tried < task_queue_size(ready) && can_start_more(p)) {
+            task_info_t* task = task_queue_take(ready, tried);
+            if (!try_start_task(p, task, now))
+                task_queue_put_back(ready, tried, task);
+            tried++;
+        }
+        task_queue_close_gaps(ready, tried);
+        stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, tried);
+        return;
+    }
+
+    /* Tasks that still wait are parked in the queue, so none is popped twice.
+       Only those go back into the heap, the untried ones stay where they are. */
+    size_t tried = 0;
+    task_info_t* task;
+    while (can_start_more(p) && (task = task_heap_pop(&p->factory.ready_heap)) != NULL) {
+        tried++;
+        if (!try_start_task(p, task, now) && task_queue_push(&p->factory.ready_tasks, task) != 0) {
+            task_completed(p, task, true);
+            ready_task_left(p, task);
+        }
+    }
+    stats_add(&p->factory.stats, STAT_TASKS_EXAMINED, tried);
+
+    while ((task = task_queue_pop(&p->factory.ready_tasks)) != NULL)
+        push_ready_task(p, task);
+}
+
+/* Done inside lock. The slot was reserved by add_worker, so only a
+   duplicate id or a failed thread start can keep the worker out. */
+static void register_worker(plant_t* p, worker_info_t* wrapper, const int64_t now)
+{
+    int prev_size = p->factory.workers.count;
+    if (worker_cont_push_back(&p->factory.workers, wrapper) != 0) {
+        p->factory.reserved_workers--;
+        worker_info_destroy(wrapper);
+        free(wrapper);
+        return;
+    }
+
+    /* Duplicates are freed by the container. */
+    if (prev_size == p->factory.workers.count) {
+        p->factory.reserved_workers--;
+        return;
+    }
+
+    wrapper->plant = p;
+    /* Pool threads pick the worker up once it gets a task. */
+    if (p->factory.n_pool_threads == 0 &&
+        pthread_create(&wrapper->thread_id, NULL, worker_thread_func, wrapper) != 0) {
+        worker_cont_pop_back(&p->factory.workers);
+        p->factory.reserved_workers--;
+        worker_info_destroy(wrapper);
+        free(wrapper);
+        return;
+    }
+
+    shift_index_add(&p->factory.shift_ends, wrapper->attr.end_ns);
+    shift_index_add(&p->factory.shift_starts, wrapper->attr.start_ns);
+    /* A shift over already counts against the ready tasks right away. */
+    if (!worker_pool_put(&p->factory.idle_workers, wrapper, now))
+        p->factory.shifts_ended = true;
+}
+
+/* Done inside lock, same checks add_task used to do inline. */
+static void register_task(plant_t* p, task_t* t, const task_attr_t* attr, const int64_t now)
+{
+    /* Retired infos are reused, so this is usually just a pop. */
+    task_info_t* wrapper = task_cont_new_task(&p->factory.tasks, t);
+    if (!wrapper)
+        return;
+    wrapper->attr = *attr;
+    wrapper->seq = p->factory.next_seq++;
+
+    int prev_size = p->factory.tasks.count;
+    if (task_cont_push_back(&p->factory.tasks, wrapper) != 0) {
+        task_cont_recycle(&p->factory.tasks, wrapper);
+        return;
+    }
+
+    /* Duplicates are recycled by the container. */
+    if (prev_size == p->factory.tasks.count)
+        return;
+
+    /* This way we check if the task can fail*/
+    p->factory.tasks.waiting_ans++;
+    if (attr->padded_results && attr->batch_function == NULL && wrapper->original_def->capacity > 0 &&
+        task_info_stage_results(wrapper) != 0) {
+        task_completed(p, wrapper, true);
+        return;
+    }
+    if (station_fits(p, wrapper))
+        free_workers_present(p, wrapper, now);
+    if (task_info_completed(wrapper))
+        return;
+    if (task_heap_push(&p->factory.start_heap, wrapper) != 0)
+        task_completed(p, wrapper, true);
+    else if (task_info_min_workers(wrapper) > p->factory.pending_widest)
+        p->factory.pending_widest = task_info_min_workers(wrapper);
+}
+
+/* Registers everything submitted so far in submission order, workers first
+   so the new tasks see them. Done inside lock, returns true if anything
+   was submitted. */
+static bool intake_submissions(plant_t* p)
+{
+    /* Tasks are taken first, so every worker submitted before them is taken too. */
+    lf_node_t* tasks = lf_stack_take_all_fifo(&p->factory.submitted_tasks);
+    lf_node_t* workers = lf_stack_take_all_fifo(&p->factory.submitted_workers);
+    if (workers == NULL && tasks == NULL)
+        return false;
+
+    int64_t now = clock_now_ns();
+    int registered = p->factory.workers.count;
+    while (workers != NULL) {
+        worker_info_t* info = LF_CONTAINER_OF(workers, worker_info_t, submit_node);
+        workers = workers->next;
+        register_worker(p, info, now);
+    }
+    if (p->factory.workers.count != registered)
+        fail_infeasible_pending_tasks(p);
+
+    while (tasks != NULL) {
+        task_submission_t* sub = LF_CONTAINER_OF(tasks, task_submission_t, node);
+        tasks = tasks->next;
+        register_task(p, sub->def, &sub->attr, now);
+        free(sub);
+    }
+    return true;
+}
+
+/* Done inside lock, once the asynchronous collector got the answer. */
+static void finish_async_collect(plant_t* p, task_info_t* task)
+{
+    trace_event(TRACE_COLLECTED, task->original_def->id, task->failed ? ERROR : PLANTOK);
+    task->collectors--;
+    task->collected = true;
+    retire_task(p, task);
+}
+
+/* Called with main_lock held, which is dropped while the callbacks run. */
+static void run_completion_callbacks(plant_t* p)
+{
+    lf_node_t* tasks = lf_stack_take_all_fifo(&p->factory.async_callbacks);
+    if (tasks == NULL)
+        return;
+
+    /* The tasks still count their collector, so they stay around meanwhile. */
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    for (lf_node_t* node = tasks; node != NULL; node = node->next) {
+        task_info_t* task = LF_CONTAINER_OF(node, task_info_t, async_node);
+        task->callback(task->original_def, task->failed ? ERROR : PLANTOK, task->callback_arg);
+    }
+    lock_main(p);
+
+    while (tasks != NULL) {
+        task_info_t* task = LF_CONTAINER_OF(tasks, task_info_t, async_node);
+        tasks = tasks->next;
+        finish_async_collect(p, task);
+    }
+}
+
+/* Sleeps outside main_lock until notified or `next_wakeup` (0 for none) comes. */
+static void manager_sleep(plant_t* p, int64_t next_wakeup, int64_t starting_time)
+{
+    int res = 0;
+    bool slept = false;
+    ASSERT_ZERO(pthread_mutex_lock(&p->wake_lock));
+    if (next_wakeup > 0 && next_wakeup > starting_time) {
+        struct timespec ts = clock_to_timespec(next_wakeup);
+        while((res == 0 && p->manager_should_sleep == true)) {
+            res = pthread_cond_timedwait(&p->factory.manager_cond, &p->wake_lock, &ts);
+            if (res != 0 && res != ETIMEDOUT) syserr("pthread condition unexpected finish");
+            slept = true;
+        }
+    } else {
+        while(p->manager_should_sleep) {
+            ASSERT_ZERO(pthread_cond_wait(&p->factory.manager_cond, &p->wake_lock));
+            slept = true;
+        }
+    }
+    if (slept)
+        stats_add(&p->factory.stats, STAT_MANAGER_WAKEUPS, 1);
+    /* Notifications from now on are for the next pass. */
+    p->manager_should_sleep = true;
+    ASSERT_ZERO(pthread_mutex_unlock(&p->wake_lock));
+}
+
+/* Only tasks whose start has come or that wait for resources are touched,
+   the next wakeup is the earliest task or worker start. */
+static void* manager_thread_func(void* arg)
+{
+    plant_t* p = arg;
+    size_t seen_expired = 0;
+    lock_main(p);
+
+    while (!p->factory.is_terminated || (p->factory.is_terminated && p->factory.tasks.waiting_ans > 0)) {
+        int64_t pass_start = clock_now_ns();
+        run_completion_callbacks(p);
+        intake_submissions(p);
+        collect_finished_work(p);
+
+        int64_t now = clock_now_ns();
+        int64_t next_wakeup = 0;
+        int64_t starting_time = now;
+
+        /* Without worker threads nobody else notices idle workers leaving. */
+        if (p->factory.n_pool_threads > 0) {
+            worker_pool_advance(&p->factory.idle_workers, now);
+            if (p->factory.idle_workers.expired != seen_expired) {
+                seen_expired = p->factory.idle_workers.expired;
+                p->factory.shifts_ended = true;
+            }
+        }
+
+        release_started_tasks(p, now);
+        /* However many shifts ended, one check covers them all. */
+        if (p->factory.shifts_ended) {
+            p->factory.shifts_ended = false;
+            fail_infeasible_ready_tasks(p, now);
+        }
+        schedule_ready_tasks(p, now);
+
+        task_info_t* next_task = task_heap_top(&p->factory.start_heap);
+        if (next_task != NULL)
+            next_wakeup = next_task->attr.start_ns;
+
+        /* Set next wakup for worker */
+        int64_t worker_start;
+        if (worker_pool_next_start(&p->factory.idle_workers, &worker_start) && worker_start > now) {
+            if (next_wakeup == 0 || worker_start < next_wakeup) {
+                next_wakeup = worker_start;
+            }
+        }
+
+        int64_t worker_end;
+        if (p->factory.n_pool_threads > 0 &&
+            worker_pool_next_end(&p->factory.idle_workers, &worker_end) && worker_end > now) {
+            if (next_wakeup == 0 || worker_end < next_wakeup) {
+                next_wakeup = worker_end;
+            }
+        }
+
+        stats_add(&p->factory.stats, STAT_MANAGER_PASSES, 1);
+        stats_add(&p->factory.stats, STAT_MANAGER_PASS_NS, clock_now_ns() - pass_start);
+
+        if (p->factory.is_terminated && p->factory.tasks.waiting_ans == 0) {
+            break;
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        manager_sleep(p, next_wakeup, starting_time);
+        lock_main(p);
+    }
+
+    /* Every task was published, so every callback is queued by now. */
+    run_completion_callbacks(p);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return NULL;
+}
+
+/* Function initializes factory if it hasn't been initialized before.
+   Does memory allocation before entering mutex for efficiency */
+static int plant_init(plant_t* p, int* stations, int n_stations, int n_workers,
+                      const plant_options_t* options)
+{
+    int level = 0;
+    factory_t f = {0};
+
+    CLEANUP_AND_RETURN(factory_init(&f, n_stations, stations, n_workers));
+    level++;
+
+    f.priority_order = options && options->order == PLANT_ORDER_PRIORITY;
+    f.backfill_enabled = options && options->backfill;
+    f.sticky_workers = options && options->sticky_workers;
+    f.n_pool_threads = options ? options->pool_threads : 0;
+    if (f.n_pool_threads == PLANT_POOL_PER_CORE)
+        f.n_pool_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (f.n_pool_threads < 0)
+        f.n_pool_threads = 0;
+    if (f.n_pool_threads > 0) {
+        f.pool_threads = malloc(sizeof(pthread_t) * f.n_pool_threads);
+        if (!f.pool_threads) {
+            factory_destroy(&f);
+            return ERROR;
+        }
+    }
+
+    if (options && options->station_cpus) {
+        f.station_cpus = malloc(sizeof(cpu_set_t) * (n_stations > 0 ? n_stations : 1));
+        if (!f.station_cpus) {
+            factory_destroy(&f);
+            return ERROR;
+        }
+        for (int i = 0; i < n_stations; i++) {
+            if (affinity_from_cpus(&f.station_cpus[i], &options->station_cpus[i]) != 0) {
+                factory_destroy(&f);
+                return ERROR;
+            }
+        }
+    }
+
+    /* Now we enter mutex end check if we can still initialize factory */
+    lock_main(p);
+
+    CLEANUP_AND_RETURN(p->factory.is_active);
+    level++;
+
+    p->factory = f;
+
+    /* We need to remember to destroy the condition when leaving mutex. */
+    CLEANUP_AND_RETURN(clock_cond_init(&p->factory.manager_cond));
+    level++;
+
+    CLEANUP_AND_RETURN(pthread_cond_init(&p->factory.jobs_cond, NULL));
+    level++;
+
+    CLEANUP_AND_RETURN(start_pool_threads(p));
+    level++;
+
+    CLEANUP_AND_RETURN(pthread_create(&p->factory.manager_thread, NULL, manager_thread_func, p));
+
+    /* Published last, submitters don't touch the factory before. */
+    atomic_store_explicit(&p->accepting, true, memory_order_release);
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return PLANTOK;
+
+    cleanup:
+        switch (level)
+        {
+            case 5:
+                stop_pool_threads(p, p->factory.n_pool_threads);
+                /* fall through */
+            case 4:
+                ASSERT_ZERO(pthread_cond_destroy(&p->factory.jobs_cond));
+                /* fall through */
+            case 3:
+                ASSERT_ZERO(pthread_cond_destroy(&p->factory.manager_cond));
+                /* fall through */
+            case 2:
+                factory_destroy(&p->factory);
+                ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+                break;
+            case 1:
+                ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+                factory_destroy(&f);
+                /* fall through */
+            default:
+                break;
+        }
+    return ERROR;
+}
+
+/* We terminate the whole plantation and wait for it to handle all tasks,
+   that run currently. */
+static int plant_shutdown(plant_t* p)
+{
+    lock_main(p);
+
+    if (factory_closed(p)) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return ERROR;
+    }
+
+    p->factory.is_terminated = true;
+    atomic_store(&p->accepting, false);
+    /* Nobody submits anymore once the ones inside are done. */
+    while (p->submitters > 0)
+        sched_yield();
+    intake_submissions(p);
+    /* Only registered workers count from now on. */
+    recheck_waiting_tasks(p);
+    notify_manager(p);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+
+    ASSERT_ZERO(pthread_join(p->factory.manager_thread, NULL));
+
+    /* After manager left we signall all remaining 
+       workers so they can leave, no worker can be added anymore. */
+    if (p->factory.n_pool_threads > 0) {
+        /* No task is left, so the job queue is empty. */
+        stop_pool_threads(p, p->factory.n_pool_threads);
+    } else {
+        int size = worker_cont_size(&p->factory.workers);
+        for (size_t i = 0; i < size; i++) {
+            worker_info_t* w = p->factory.workers.items[i];
+            ASSERT_ZERO(pthread_mutex_lock(&w->lock));
+            ASSERT_ZERO(pthread_cond_signal(&w->wakeup_cond));
+            ASSERT_ZERO(pthread_mutex_unlock(&w->lock));
+        }
+
+        for (size_t i = 0; i < p->factory.workers.count; i++) {
+            worker_info_t* w = p->factory.workers.items[i];
+            ASSERT_ZERO(pthread_join(w->thread_id, NULL));
+        }
+    }
+
+    lock_main(p);
+
+    factory_destroy(&p->factory);
+    ASSERT_ZERO(pthread_cond_destroy(&p->factory.manager_cond));
+    ASSERT_ZERO(pthread_cond_destroy(&p->factory.jobs_cond));
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+
+    return PLANTOK;
+}
+
+static plant_t* plant_resolve(plant_t* p)
+{
+    return p ? p : &default_plant;
+}
+
+int init_plant(int* stations, int n_stations, int n_workers)
+{
+    return init_plant_ex(stations, n_stations, n_workers, NULL);
+}
+
+int init_plant_ex(int* stations, int n_stations, int n_workers, const plant_options_t* options)
+{
+    return plant_init(&default_plant, stations, n_stations, n_workers, options);
+}
+
+int destroy_plant()
+{
+    return plant_shutdown(&default_plant);
+}
+
+plant_t* plant_create(int* stations, int n_stations, int n_workers, const plant_options_t* options)
+{
+    plant_t* p = calloc(1, sizeof(plant_t));
+    if (!p) return NULL;
+
+    ASSERT_ZERO(pthread_mutex_init(&p->main_lock, NULL));
+    ASSERT_ZERO(pthread_mutex_init(&p->wake_lock, NULL));
+    ASSERT_ZERO(pthread_mutex_init(&p->jobs_lock, NULL));
+    ASSERT_ZERO(pthread_mutex_init(&p->any_lock, NULL));
+    ASSERT_ZERO(pthread_cond_init(&p->any_cond, NULL));
+
+    if (plant_init(p, stations, n_stations, n_workers, options) != PLANTOK) {
+        ASSERT_ZERO(pthread_cond_destroy(&p->any_cond));
+        ASSERT_ZERO(pthread_mutex_destroy(&p->any_lock));
+        ASSERT_ZERO(pthread_mutex_destroy(&p->jobs_lock));
+        ASSERT_ZERO(pthread_mutex_destroy(&p->wake_lock));
+        ASSERT_ZERO(pthread_mutex_destroy(&p->main_lock));
+        free(p);
+        return NULL;
+    }
+    return p;
+}
+
+int plant_destroy(plant_t* p)
+{
+    if (!p)
+        return destroy_plant();
+
+    if (plant_shutdown(p) != PLANTOK)
+        return ERROR;
+
+    ASSERT_ZERO(pthread_cond_destroy(&p->any_cond));
+    ASSERT_ZERO(pthread_mutex_destroy(&p->any_lock));
+    ASSERT_ZERO(pthread_mutex_destroy(&p->jobs_lock));
+    ASSERT_ZERO(pthread_mutex_destroy(&p->wake_lock));
+    ASSERT_ZERO(pthread_mutex_destroy(&p->main_lock));
+    free(p);
+    return PLANTOK;
+}
+
+int64_t plant_now_ns(void)
+{
+    return clock_now_ns();
+}
+
+void* plant_alloc_on_cpus(const plant_cpu_set_t* cpus, size_t size)
+{
+    cpu_set_t set;
+    if (affinity_from_cpus(&set, cpus) != 0)
+        return NULL;
+    return affinity_alloc(&set, size);
+}
+
+/* Fills the attributes the caller left out from the worker's definition. */
+static worker_attr_t resolve_worker_attr(const worker_t* w, const worker_attr_t* attr)
+{
+    worker_attr_t res = attr ? *attr : (worker_attr_t){0};
+    if (res.start_ns == 0)
+        res.start_ns = clock_from_wall(w->start);
+    if (res.end_ns == 0)
+        res.end_ns = clock_from_wall(w->end);
+    return res;
+}
+
+/* Fills the attributes the caller left out from the task's definition. */
+static task_attr_t resolve_task_attr(const task_t* t, const task_attr_t* attr)
+{
+    task_attr_t res = attr ? *attr : (task_attr_t){0};
+    if (res.start_ns == 0)
+        res.start_ns = clock_from_wall(t->start);
+    return res;
+}
+
+static worker_info_t* new_worker_info(worker_t* w, const worker_attr_t* attr)
+{
+    worker_info_t* wrapper = calloc(1,sizeof(worker_info_t));
+    if (!wrapper) return NULL;
+
+    if (worker_info_init(wrapper, w) != 0) {
+        free(wrapper);
+        return NULL;
+    }
+    wrapper->attr = resolve_worker_attr(w, attr);
+    /* The caller's CPU list doesn't have to outlive the call. */
+    if (affinity_from_cpus(&wrapper->cpus, &wrapper->attr.cpus) != 0) {
+        worker_info_destroy(wrapper);
+        free(wrapper);
+        return NULL;
+    }
+    wrapper->attr.cpus = (plant_cpu_set_t){0};
+    return wrapper;
+}
+
+/* Frees a chain of workers the plant didn't take. */
+static void free_worker_chain(lf_node_t* node)
+{
+    while (node != NULL) {
+        worker_info_t* wrapper = LF_CONTAINER_OF(node, worker_info_t, submit_node);
+        node = node->next;
+        worker_info_destroy(wrapper);
+        free(wrapper);
+    }
+}
+
+/* Hands `n` workers linked from `first` to `last` over to the manager. */
+static int submit_workers(plant_t* p, lf_node_t* first, lf_node_t* last, int n)
+{
+    if (!submission_begin(p))
+        return ERROR;
+
+    /* All `n_workers` slots are promised already. */
+    if ((p->factory.reserved_workers += n) > p->factory.workers.capacity) {
+        p->factory.reserved_workers -= n;
+        submission_end(p);
+        return ERROR;
+    }
+
+    if (lf_stack_push_chain(&p->factory.submitted_workers, first, last))
+        notify_manager(p);
+    submission_end(p);
+
+    return PLANTOK;
+}
+
+int add_worker(worker_t* w)
+{
+    return plant_add_worker(NULL, w, NULL);
+}
+
+int add_worker_ex(worker_t* w, const worker_attr_t* attr)
+{
+    return plant_add_worker(NULL, w, attr);
+}
+
+int plant_add_worker(plant_t* p, worker_t* w, const worker_attr_t* attr)
+{
+    p = plant_resolve(p);
+    if (!w) {
+        return ERROR;
+    }
+
+    worker_info_t* wrapper = new_worker_info(w, attr);
+    if (!wrapper) return ERROR;
+
+    wrapper->submit_node.next = NULL;
+    if (submit_workers(p, &wrapper->submit_node, &wrapper->submit_node, 1) != PLANTOK) {
+        free_worker_chain(&wrapper->submit_node);
+        return ERROR;
+    }
+    return PLANTOK;
+}
+
+int add_workers(worker_t** w, int n)
+{
+    return plant_add_workers(NULL, w, n);
+}
+
+int plant_add_workers(plant_t* p, worker_t** w, int n)
+{
+    p = plant_resolve(p);
+    if (!w || n < 0) return ERROR;
+    if (n == 0) return PLANTOK;
+    for (int i = 0; i < n; i++) {
+        if (!w[i]) return ERROR;
+    }
+
+    /* Linked newest first, like single pushes would leave them. */
+    lf_node_t* first = NULL;
+    lf_node_t* last = NULL;
+    for (int i = 0; i < n; i++) {
+        worker_info_t* wrapper = new_worker_info(w[i], NULL);
+        if (!wrapper) {
+            free_worker_chain(first);
+            return ERROR;
+        }
+        wrapper->submit_node.next = first;
+        first = &wrapper->submit_node;
+        if (last == NULL)
+            last = first;
+    }
+
+    if (submit_workers(p, first, last, n) != PLANTOK) {
+        free_worker_chain(first);
+        return ERROR;
+    }
+    return PLANTOK;
+}
+
+/* Frees a chain of submissions the plant didn't take. */
+static void free_task_chain(lf_node_t* node)
+{
+    while (node != NULL) {
+        task_submission_t* sub = LF_CONTAINER_OF(node, task_submission_t, node);
+        node = node->next;
+        free(sub);
+    }
+}
+
+/* Hands `n` tasks linked from `first` to `last` over to the manager. */
+static int submit_tasks(plant_t* p, lf_node_t* first, lf_node_t* last, int n)
+{
+    if (!submission_begin(p))
+        return ERROR;
+
+    stats_add(&p->factory.stats, STAT_TASKS_SUBMITTED, n);
+    if (trace_enabled()) {
+        for (lf_node_t* node = first; node != NULL; node = node->next)
+            trace_event(TRACE_ADD_TASK, LF_CONTAINER_OF(node, task_submission_t, node)->def->id, 0);
+    }
+    if (lf_stack_push_chain(&p->factory.submitted_tasks, first, last))
+        notify_manager(p);
+    submission_end(p);
+
+    return PLANTOK;
+}
+
+int add_task(task_t* t)
+{
+    return plant_add_task(NULL, t, NULL);
+}
+
+int add_task_ex(task_t* t, const task_attr_t* attr)
+{
+    return plant_add_task(NULL, t, attr);
+}
+
+int plant_add_task(plant_t* p, task_t* t, const task_attr_t* attr)
+{
+    p = plant_resolve(p);
+    if (!t) {
+        return ERROR;
+    }
+
+    task_submission_t* sub = malloc(sizeof(task_submission_t));
+    if (!sub) return ERROR;
+    sub->def = t;
+    sub->attr = resolve_task_attr(t, attr);
+    sub->node.next = NULL;
+
+    if (submit_tasks(p, &sub->node, &sub->node, 1) != PLANTOK) {
+        free(sub);
+        return ERROR;
+    }
+    return PLANTOK;
+}
+
+int add_tasks(task_t** t, int n)
+{
+    return plant_add_tasks(NULL, t, n);
+}
+
+int plant_add_tasks(plant_t* p, task_t** t, int n)
+{
+    p = plant_resolve(p);
+    if (!t || n < 0) return ERROR;
+    if (n == 0) return PLANTOK;
+    for (int i = 0; i < n; i++) {
+        if (!t[i]) return ERROR;
+    }
+
+    /* Linked newest first, like single pushes would leave them. */
+    lf_node_t* first = NULL;
+    lf_node_t* last = NULL;
+    for (int i = 0; i < n; i++) {
+        task_submission_t* sub = malloc(sizeof(task_submission_t));
+        if (!sub) {
+            free_task_chain(first);
+            return ERROR;
+        }
+        sub->def = t[i];
+        sub->attr = resolve_task_attr(t[i], NULL);
+        sub->node.next = first;
+        first = &sub->node;
+        if (last == NULL)
+            last = first;
+    }
+
+    if (submit_tasks(p, first, last, n) != PLANTOK) {
+        free_task_chain(first);
+        return ERROR;
+    }
+    return PLANTOK;
+}
+
+static bool can_be_collected(plant_t* p, task_t *t, task_info_t** wrapper)
+{
+    *wrapper = task_cont_find(&p->factory.tasks, t->id);
+    return *wrapper != NULL;
+}
+
+/* Called as a collector of `task`, so the task can't be retired meanwhile. */
+static void wait_for_task(task_info_t* task)
+{
+    unsigned state = atomic_load(&task->completion);
+    while (!(state & TASK_DONE)) {
+        /* Announce ourselves, so the publisher knows to wake us. */
+        if (!(state & TASK_WAITERS) &&
+            !atomic_compare_exchange_weak(&task->completion, &state, state | TASK_WAITERS))
+            continue;
+        futex_wait(&task->completion, state | TASK_WAITERS);
+        state = atomic_load(&task->completion);
+    }
+}
+
+static bool any_completed(task_info_t** wrappers, int n)
+{
+    for (int i = 0; i < n; i++) {
+        if (wrappers[i] != NULL && task_info_completed(wrappers[i]))
+            return true;
+    }
+    return false;
+}
+
+/* Called as a collector of every known task in `wrappers`. */
+static void wait_for_any(plant_t* p, task_info_t** wrappers, int n)
+{
+    /* Registered before checking, so a completion either is seen here or wakes us. */
+    p->any_waiters++;
+    ASSERT_ZERO(pthread_mutex_lock(&p->any_lock));
+    while (!any_completed(wrappers, n)) {
+        ASSERT_ZERO(pthread_cond_wait(&p->any_cond, &p->any_lock));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&p->any_lock));
+    p->any_waiters--;
+}
+
+int collect_task(task_t* t)
+{
+    return plant_collect_task(NULL, t);
+}
+
+int plant_collect_task(plant_t* p, task_t* t)
+{
+    int status;
+    if (plant_collect_tasks(p, &t, 1, PLANT_WAIT_ALL, &status) != PLANTOK)
+        return ERROR;
+    return status;
+}
+
+/* Small batches, like a single collect_task, don't allocate. */
+#define COLLECT_ON_STACK 8
+
+int collect_tasks(task_t** t, int n, plant_wait_t mode, int* status)
+{
+    return plant_collect_tasks(NULL, t, n, mode, status);
+}
+
+int plant_collect_tasks(plant_t* p, task_t** t, int n, plant_wait_t mode, int* status)
+{
+    p = plant_resolve(p);
+    if (!t || !status || n < 0)
+        return ERROR;
+    for (int i = 0; i < n; i++) {
+        if (!t[i]) return ERROR;
+    }
+
+    task_info_t* on_stack[COLLECT_ON_STACK];
+    task_info_t** wrappers = on_stack;
+    if (n > COLLECT_ON_STACK) {
+        wrappers = malloc(sizeof(task_info_t*) * n);
+        if (!wrappers) return ERROR;
+    }
+
+    lock_main(p);
+
+    /* The tasks may still wait in the submission stack. */
+    if (!factory_closed(p) && intake_submissions(p))
+        notify_manager(p);
+
+    if (factory_closed(p)) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        if (wrappers != on_stack) free(wrappers);
+        return ERROR;
+    }
+
+    /* While we are a collector the task isn't retired, so it's safe
+       to wait for it on its own lock. */
+    int found = 0;
+    for (int i = 0; i < n; i++) {
+        if (can_be_collected(p, t[i], &wrappers[i])) {
+            wrappers[i]->collectors++;
+            found++;
+        }
+    }
+    p->factory.tasks.waiting_ans += found;
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+
+    if (mode == PLANT_WAIT_ANY) {
+        if (found > 0)
+            wait_for_any(p, wrappers, n);
+    } else {
+        for (int i = 0; i < n; i++) {
+            if (wrappers[i] != NULL)
+                wait_for_task(wrappers[i]);
+        }
+    }
+
+    lock_main(p);
+    for (int i = 0; i < n; i++) {
+        task_info_t* wrapper = wrappers[i];
+        if (wrapper == NULL) {
+            status[i] = ERROR;
+            continue;
+        }
+
+        wrapper->collectors--;
+        if (!task_info_completed(wrapper)) {
+            status[i] = PLANT_PENDING;
+            continue;
+        }
+        status[i] = wrapper->failed ? ERROR : PLANTOK;
+        wrapper->collected = true;
+    }
+    p->factory.tasks.waiting_ans -= found;
+    collect_finished_work(p);
+
+    for (int i = 0; i < n; i++) {
+        /* A task listed twice is retired only once. */
+        if (wrappers[i] != NULL &&
+            task_cont_find(&p->factory.tasks, t[i]->id) == wrappers[i] &&
+            wrappers[i]->collected)
+            retire_task(p, wrappers[i]);
+    }
+
+    if (p->factory.is_terminated && p->factory.tasks.waiting_ans == 0)
+        notify_manager(p);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+
+    if (trace_enabled()) {
+        for (int i = 0; i < n; i++)
+            trace_event(TRACE_COLLECTED, t[i]->id, status[i]);
+    }
+
+    if (wrappers != on_stack) free(wrappers);
+    return PLANTOK;
+}
+
+int collect_task_async(task_t* t, task_callback_t cb, void* arg)
+{
+    return plant_collect_task_async(NULL, t, cb, arg);
+}
+
+int plant_collect_task_async(plant_t* p, task_t* t, task_callback_t cb, void* arg)
+{
+    p = plant_resolve(p);
+    if (!t)
+        return ERROR;
+
+    task_info_t* wrapper = NULL;
+
+    lock_main(p);
+
+    /* The task may still wait in the submission stack. */
+    if (!factory_closed(p) && intake_submissions(p))
+        notify_manager(p);
+
+    if (factory_closed(p) ||
+        !can_be_collected(p, t, &wrapper)) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return ERROR;
+    }
+
+    /* Registrations hold main_lock, only the publisher races with us. */
+    if (atomic_load(&wrapper->completion) & TASK_ASYNC) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return ERROR;
+    }
+    wrapper->callback = cb;
+    wrapper->callback_arg = arg;
+    /* Either we see TASK_DONE or the publisher sees us. */
+    bool done = atomic_fetch_or(&wrapper->completion, TASK_ASYNC) & TASK_DONE;
+
+    /* Nobody waits for the answer, so the plant isn't kept alive for it. */
+    wrapper->collectors++;
+    if (done)
+        deliver_async(p, wrapper);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return PLANTOK;
+}
+
+int plant_trace_start(int events_per_thread)
+{
+    return trace_start(events_per_thread) == 0 ? PLANTOK : ERROR;
+}
+
+void plant_trace_stop(void)
+{
+    trace_stop();
+}
+
+int plant_trace_dump(const char* path)
+{
+    if (!path)
+        return ERROR;
+    return trace_dump(path) == 0 ? PLANTOK : ERROR;
+}
+
+int plant_get_stats(plant_t* p, plant_stats_t* stats)
+{
+    p = plant_resolve(p);
+    if (!stats)
+        return ERROR;
+
+    lock_main(p);
+    if (!p->factory.is_active) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return ERROR;
+    }
+    /* Stations of finished tasks are free already. */
+    collect_finished_work(p);
+
+    const stats_t* c = &p->factory.stats;
+    stats->tasks_submitted = stats_read(c, STAT_TASKS_SUBMITTED);
+    stats->tasks_started = stats_read(c, STAT_TASKS_STARTED);
+    stats->tasks_completed = stats_read(c, STAT_TASKS_COMPLETED);
+    stats->tasks_infeasible = stats_read(c, STAT_TASKS_INFEASIBLE);
+    stats->manager_wakeups = stats_read(c, STAT_MANAGER_WAKEUPS);
+    stats->manager_passes = stats_read(c, STAT_MANAGER_PASSES);
+    stats->manager_pass_ns = stats_read(c, STAT_MANAGER_PASS_NS);
+    stats->tasks_examined = stats_read(c, STAT_TASKS_EXAMINED);
+    stats->worker_busy_ns = stats_read(c, STAT_WORKER_BUSY_NS);
+    stats->worker_idle_ns = stats_read(c, STAT_WORKER_IDLE_NS);
+    stats->stations_busy = p->factory.n_stations - station_index_free_count(&p->factory.stations);
+    stats->station_busy_ns = stats_read(c, STAT_STATION_BUSY_NS);
+    stats->main_lock_wait_ns = stats_read(c, STAT_MAIN_LOCK_WAIT_NS);
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return PLANTOK;
+}
+
+int plant_completion_fd(plant_t* p)
+{
+    p = plant_resolve(p);
+    lock_main(p);
+    int fd = p->factory.is_active ? p->factory.completion_fd : ERROR;
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return fd;
+}
+
+/* Reports tasks from the front of `tasks` into the free places from `n` on,
+   returns how many places are filled. Done inside lock. */
+static int report_drained(plant_t* p, lf_node_t** tasks, int* ids, int* status, int n, int max)
+{
+    while (*tasks != NULL && n < max) {
+        task_info_t* task = LF_CONTAINER_OF(*tasks, task_info_t, async_node);
+        *tasks = (*tasks)->next;
+
+        ids[n] = task->original_def->id;
+        status[n] = task->failed ? ERROR : PLANTOK;
+        n++;
+        finish_async_collect(p, task);
+    }
+    return n;
+}
+
+int plant_drain_completed(plant_t* p, int* ids, int* status, int max)
+{
+    p = plant_resolve(p);
+    if (!ids || !status || max < 0)
+        return ERROR;
+
+    lock_main(p);
+
+    /* Still works while the plant terminates. */
+    if (!p->factory.is_active) {
+        ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+        return ERROR;
+    }
+
+    /* Reset before taking the tasks, a later completion signals again. */
+    uint64_t count;
+    if (read(p->factory.completion_fd, &count, sizeof(count)) == -1 && errno != EAGAIN)
+        syserr("Failed to read the completion eventfd");
+
+    collect_finished_work(p);
+
+    /* What didn't fit last time completed first, so it goes first. */
+    int n = report_drained(p, &p->factory.drain_leftover, ids, status, 0, max);
+    if (p->factory.drain_leftover == NULL) {
+        p->factory.drain_leftover = lf_stack_take_all_fifo(&p->factory.async_drain);
+        n = report_drained(p, &p->factory.drain_leftover, ids, status, n, max);
+    }
+
+    /* Whatever didn't fit is reported by the next call. */
+    if (p->factory.drain_leftover != NULL) {
+        uint64_t one = 1;
+        if (write(p->factory.completion_fd, &one, sizeof(one)) != sizeof(one))
+            syserr("Failed to signal the completion eventfd");
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&p->main_lock));
+    return n;
 }
\ No newline at end of file
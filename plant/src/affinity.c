@@ -0,0 +1,51 @@
+#include "../headers/affinity.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+int affinity_from_cpus(cpu_set_t* set, const plant_cpu_set_t* cpus)
+{
+    CPU_ZERO(set);
+    if (cpus == NULL)
+        return 0;
+    if (cpus->n_cpus < 0 || (cpus->n_cpus > 0 && cpus->cpus == NULL))
+        return -1;
+
+    for (int i = 0; i < cpus->n_cpus; i++) {
+        if (cpus->cpus[i] < 0 || cpus->cpus[i] >= CPU_SETSIZE)
+            return -1;
+        CPU_SET(cpus->cpus[i], set);
+    }
+    return 0;
+}
+
+bool affinity_pinned(const cpu_set_t* set)
+{
+    return CPU_COUNT(set) > 0;
+}
+
+void affinity_apply(const cpu_set_t* set)
+{
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), set);
+}
+
+void* affinity_alloc(const cpu_set_t* set, size_t size)
+{
+    void* mem = malloc(size > 0 ? size : 1);
+    if (mem == NULL)
+        return NULL;
+
+    cpu_set_t old;
+    bool moved = affinity_pinned(set) &&
+                 pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &old) == 0;
+    if (moved)
+        affinity_apply(set);
+
+    /* Pages go to the node of the first write, calloc might not write at all. */
+    memset(mem, 0, size);
+
+    if (moved)
+        affinity_apply(&old);
+    return mem;
+}
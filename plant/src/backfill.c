@@ -0,0 +1,126 @@
+#include "../headers/backfill.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int backfill_init(backfill_t* b, int n_stations)
+{
+    *b = (backfill_t) {0};
+    b->running = malloc(sizeof(backfill_running_t) * (n_stations > 0 ? n_stations : 1));
+    return b->running ? 0 : -1;
+}
+
+void backfill_destroy(backfill_t* b)
+{
+    free(b->running);
+    *b = (backfill_t) {0};
+}
+
+void backfill_clear(backfill_t* b)
+{
+    b->task = NULL;
+}
+
+void backfill_add_running(backfill_t* b, int station, int64_t end_ns, int workers, int station_capacity)
+{
+    /* After the ones ending at the same moment. */
+    int i = b->n_running;
+    while (i > 0 && b->running[i - 1].end_ns > end_ns) {
+        b->running[i] = b->running[i - 1];
+        i--;
+    }
+    b->running[i] = (backfill_running_t) {
+        .end_ns = end_ns,
+        .station = station,
+        .workers = workers,
+        .station_capacity = station_capacity,
+    };
+    b->n_running++;
+}
+
+void backfill_remove_running(backfill_t* b, int station)
+{
+    int i = 0;
+    while (i < b->n_running && b->running[i].station != station)
+        i++;
+    if (i == b->n_running)
+        return;
+    memmove(&b->running[i], &b->running[i + 1], sizeof(backfill_running_t) * (b->n_running - i - 1));
+    b->n_running--;
+}
+
+void backfill_reserve(backfill_t* b, task_info_t* task, int idle, int fitting_stations,
+                      const int64_t* starts, size_t n_starts, int64_t now)
+{
+    int needed = task_info_min_workers(task);
+    int workers = idle;
+    int stations = fitting_stations;
+    int64_t start = now;
+
+    /* Hand back running tasks and take in starting workers in time order
+       until the task fits, together with everything at the same moment. */
+    int i = 0;
+    size_t j = 0;
+    while ((i < b->n_running || j < n_starts) && (workers < needed || stations == 0)) {
+        int64_t next = i < b->n_running ? b->running[i].end_ns : BACKFILL_UNKNOWN;
+        if (j < n_starts && starts[j] < next)
+            next = starts[j];
+        start = next > now ? next : now;
+        for (; i < b->n_running && b->running[i].end_ns <= start; i++) {
+            workers += b->running[i].workers;
+            if (b->running[i].station_capacity >= needed)
+                stations++;
+        }
+        for (; j < n_starts && starts[j] <= start; j++)
+            workers++;
+    }
+
+    b->task = NULL;
+    if (workers < needed || stations == 0)
+        return;
+
+    /* Waiting on work without an expected duration leaves it BACKFILL_UNKNOWN. */
+    b->task = task;
+    b->start_ns = start;
+    b->spare_workers = workers - needed;
+    b->spare_stations = stations - 1;
+}
+
+void backfill_forget(backfill_t* b, const task_info_t* task)
+{
+    if (b->task == task)
+        b->task = NULL;
+}
+
+/* Expected to hand its workers and station back before the reservation starts. */
+static bool ends_in_time(const backfill_t* b, const task_info_t* task, int64_t now)
+{
+    int64_t expected = task->attr.expected_ns;
+    return b->start_ns != BACKFILL_UNKNOWN && expected > 0 && expected <= b->start_ns - now;
+}
+
+bool backfill_allows(const backfill_t* b, const task_info_t* task, int workers, int station_capacity,
+                     int64_t now)
+{
+    if (b->task == NULL || b->task == task || ends_in_time(b, task, now))
+        return true;
+
+    return workers <= b->spare_workers &&
+           (station_capacity < task_info_min_workers(b->task) || b->spare_stations > 0);
+}
+
+void backfill_started(backfill_t* b, const task_info_t* task, int station_capacity, int64_t now)
+{
+    if (b->task == NULL)
+        return;
+    if (b->task == task) {
+        b->task = NULL;
+        return;
+    }
+    if (ends_in_time(b, task, now))
+        return;
+
+    b->spare_workers -= task->n_workers;
+    if (station_capacity >= task_info_min_workers(b->task))
+        b->spare_stations--;
+}
@@ -3,39 +3,63 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 int factory_init(factory_t* f, int n_stations, int* station_capacities, int n_workers)
 {
+    f->completion_fd = -1;
     f->n_stations = n_stations;
     f->is_active = true;
     f->is_terminated = false;
+    job_queue_init(&f->jobs);
+    lf_stack_init(&f->finished_tasks);
+    lf_stack_init(&f->returned_workers);
+    lf_stack_init(&f->submitted_tasks);
+    lf_stack_init(&f->submitted_workers);
+    atomic_init(&f->reserved_workers, 0);
+    lf_stack_init(&f->async_callbacks);
+    lf_stack_init(&f->async_drain);
+    f->drain_leftover = NULL;
+    f->station_cpus = NULL;
+    stats_init(&f->stats);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &f->all_cpus) != 0)
+        CPU_ZERO(&f->all_cpus);
 
     f->station_capacity = malloc(sizeof(int) * n_stations);
-    if (!f->station_capacity) {
-        return -1;
-    }
+    if (!f->station_capacity)
+        goto cleanup;
     memcpy(f->station_capacity, station_capacities, sizeof(int) * n_stations);
 
-    f->station_usage = calloc(n_stations, sizeof(int));
-    if (!f->station_usage) {
-        free(f->station_capacity);
-        return -1;   
-    }
-
-    if (task_cont_init(&f->tasks) != 0) {
-        free(f->station_usage);
-        free(f->station_capacity);
-        return -1;
-    }
-
-    if (worker_cont_init(&f->workers, n_workers) != 0) {
-        free(f->station_usage);
-        free(f->station_capacity);
-        task_cont_destroy(&f->tasks);
-        return -1;
-    }
+    f->station_usage = calloc(n_stations, sizeof(atomic_int));
+    if (!f->station_usage)
+        goto cleanup;
+
+    f->station_task = calloc(n_stations > 0 ? n_stations : 1, sizeof(task_info_t*));
+    if (!f->station_task)
+        goto cleanup;
+
+    if (station_index_init(&f->stations, station_capacities, n_stations) != 0 ||
+        task_cont_init(&f->tasks) != 0 ||
+        task_heap_init(&f->start_heap, task_heap_by_start, SCHED_START_HEAP) != 0 ||
+        task_heap_init(&f->ready_heap, task_heap_by_priority, SCHED_READY) != 0 ||
+        task_queue_init(&f->ready_tasks) != 0 ||
+        worker_cont_init(&f->workers, n_workers) != 0 ||
+        worker_pool_init(&f->idle_workers, n_workers, n_stations) != 0 ||
+        shift_index_init(&f->shift_ends, n_workers) != 0 ||
+        shift_index_init(&f->shift_starts, n_workers) != 0 ||
+        backfill_init(&f->backfill, n_stations) != 0)
+        goto cleanup;
+
+    f->completion_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (f->completion_fd == -1)
+        goto cleanup;
 
     return 0;
+
+cleanup:
+    factory_destroy(f);
+    return -1;
 }
 
 /* Can't destory factory if it wasn't initialized before with condition */
@@ -43,12 +67,37 @@ void factory_destroy(factory_t* f)
 {
     free(f->station_usage);
     free(f->station_capacity);
+    free(f->station_cpus);
+    free(f->station_task);
     f->station_capacity = NULL;
+    f->station_task = NULL;
+    f->station_cpus = NULL;
     f->station_usage = NULL;
     f->n_stations = 0;
+    station_index_destroy(&f->stations);
     f->is_active = false;
     f->is_terminated = false;
 
     task_cont_destroy(&f->tasks);
+    task_heap_destroy(&f->start_heap);
+    task_queue_destroy(&f->ready_tasks);
+    task_heap_destroy(&f->ready_heap);
+    backfill_destroy(&f->backfill);
     worker_cont_free(&f->workers);
+    worker_pool_destroy(&f->idle_workers);
+    shift_index_destroy(&f->shift_ends);
+    shift_index_destroy(&f->shift_starts);
+
+    free(f->pool_threads);
+    f->pool_threads = NULL;
+    f->n_pool_threads = 0;
+    f->pool_stopping = false;
+    job_queue_init(&f->jobs);
+
+    if (f->completion_fd != -1)
+        close(f->completion_fd);
+    f->completion_fd = -1;
+    lf_stack_init(&f->async_callbacks);
+    lf_stack_init(&f->async_drain);
+    f->drain_leftover = NULL;
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "../headers/futex.h"
+#include "../../common/err.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+void futex_wait(atomic_uint* word, unsigned expected)
+{
+    if (syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0) == -1 &&
+        errno != EAGAIN && errno != EINTR)
+        syserr("futex wait failed");
+}
+
+void futex_wake_all(atomic_uint* word)
+{
+    ASSERT_SYS_OK(syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0));
+}
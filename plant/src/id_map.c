@@ -0,0 +1,133 @@
+#include "../headers/id_map.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static size_t id_hash(int key)
+{
+    uint32_t h = (uint32_t)key;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static int id_map_alloc(id_map_t* map, size_t n_slots)
+{
+    map->slots = calloc(n_slots, sizeof(id_map_slot_t));
+    if (!map->slots)
+        return -1;
+    map->mask = n_slots - 1;
+    map->count = 0;
+    return 0;
+}
+
+static void id_map_insert_new(id_map_t* map, int key, void* value)
+{
+    size_t i = id_hash(key) & map->mask;
+    while (map->slots[i].value != NULL)
+        i = (i + 1) & map->mask;
+
+    map->slots[i].key = key;
+    map->slots[i].value = value;
+    map->count++;
+}
+
+static int id_map_grow(id_map_t* map)
+{
+    id_map_t bigger;
+    size_t old_size = map->mask + 1;
+
+    if (id_map_alloc(&bigger, old_size * 2) != 0)
+        return -1;
+
+    for (size_t i = 0; i < old_size; i++) {
+        if (map->slots[i].value != NULL)
+            id_map_insert_new(&bigger, map->slots[i].key, map->slots[i].value);
+    }
+
+    free(map->slots);
+    *map = bigger;
+    return 0;
+}
+
+int id_map_init(id_map_t* map, size_t expected)
+{
+    /* Keep the load factor at most 1/2. */
+    size_t n_slots = 16;
+    while (n_slots < expected * 2)
+        n_slots *= 2;
+
+    return id_map_alloc(map, n_slots);
+}
+
+void id_map_destroy(id_map_t* map)
+{
+    free(map->slots);
+    map->slots = NULL;
+    map->mask = 0;
+    map->count = 0;
+}
+
+void* id_map_get(const id_map_t* map, int key)
+{
+    size_t i = id_hash(key) & map->mask;
+    while (map->slots[i].value != NULL) {
+        if (map->slots[i].key == key)
+            return map->slots[i].value;
+        i = (i + 1) & map->mask;
+    }
+    return NULL;
+}
+
+int id_map_put(id_map_t* map, int key, void* value)
+{
+    size_t i = id_hash(key) & map->mask;
+    while (map->slots[i].value != NULL) {
+        if (map->slots[i].key == key) {
+            map->slots[i].value = value;
+            return 0;
+        }
+        i = (i + 1) & map->mask;
+    }
+
+    if ((map->count + 1) * 2 > map->mask + 1) {
+        if (id_map_grow(map) != 0)
+            return -1;
+    }
+
+    id_map_insert_new(map, key, value);
+    return 0;
+}
+
+void id_map_remove(id_map_t* map, int key)
+{
+    size_t i = id_hash(key) & map->mask;
+    while (map->slots[i].value != NULL && map->slots[i].key != key)
+        i = (i + 1) & map->mask;
+
+    if (map->slots[i].value == NULL)
+        return;
+
+    /* Move back every following entry that would become unreachable. */
+    size_t hole = i;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & map->mask;
+        if (map->slots[j].value == NULL)
+            break;
+
+        size_t home = id_hash(map->slots[j].key) & map->mask;
+        bool movable = hole <= j ? (home <= hole || home > j) : (home <= hole && home > j);
+        if (movable) {
+            map->slots[hole] = map->slots[j];
+            hole = j;
+        }
+    }
+
+    map->slots[hole].value = NULL;
+    map->count--;
+}
@@ -0,0 +1,37 @@
+#include "../headers/job_queue.h"
+
+#include <stddef.h>
+
+void job_queue_init(job_queue_t* queue)
+{
+    queue->head = NULL;
+    queue->tail = NULL;
+}
+
+void job_queue_push(job_queue_t* queue, worker_info_t* w)
+{
+    w->next_job = NULL;
+    if (queue->tail != NULL)
+        queue->tail->next_job = w;
+    else
+        queue->head = w;
+    queue->tail = w;
+}
+
+worker_info_t* job_queue_pop(job_queue_t* queue)
+{
+    worker_info_t* w = queue->head;
+    if (w == NULL)
+        return NULL;
+
+    queue->head = w->next_job;
+    if (queue->head == NULL)
+        queue->tail = NULL;
+    w->next_job = NULL;
+    return w;
+}
+
+bool job_queue_empty(const job_queue_t* queue)
+{
+    return queue->head == NULL;
+}
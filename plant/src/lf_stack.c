@@ -0,0 +1,39 @@
+#include "../headers/lf_stack.h"
+
+void lf_stack_init(lf_stack_t* stack)
+{
+    atomic_init(&stack->head, NULL);
+}
+
+bool lf_stack_push(lf_stack_t* stack, lf_node_t* node)
+{
+    return lf_stack_push_chain(stack, node, node);
+}
+
+bool lf_stack_push_chain(lf_stack_t* stack, lf_node_t* first, lf_node_t* last)
+{
+    lf_node_t* head = atomic_load_explicit(&stack->head, memory_order_relaxed);
+    do {
+        last->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&stack->head, &head, first,
+        memory_order_release, memory_order_relaxed));
+    return head == NULL;
+}
+
+lf_node_t* lf_stack_take_all(lf_stack_t* stack)
+{
+    return atomic_exchange_explicit(&stack->head, NULL, memory_order_acquire);
+}
+
+lf_node_t* lf_stack_take_all_fifo(lf_stack_t* stack)
+{
+    lf_node_t* node = lf_stack_take_all(stack);
+    lf_node_t* reversed = NULL;
+    while (node != NULL) {
+        lf_node_t* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+    return reversed;
+}
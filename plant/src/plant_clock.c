@@ -0,0 +1,55 @@
+#include "../headers/plant_clock.h"
+
+static int64_t timespec_to_ns(const struct timespec* ts)
+{
+    return (int64_t)ts->tv_sec * NS_PER_SEC + ts->tv_nsec;
+}
+
+int64_t clock_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return timespec_to_ns(&ts);
+}
+
+int64_t clock_from_wall(time_t wall)
+{
+    struct timespec real;
+    struct timespec mono;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+
+    /* Saturated instead of overflowing, so a wall time like LLONG_MAX is
+       still the far future. */
+    int64_t offset = timespec_to_ns(&mono) - timespec_to_ns(&real);
+    if (wall > (INT64_MAX - (offset > 0 ? offset : 0)) / NS_PER_SEC)
+        return INT64_MAX;
+    if (wall < (INT64_MIN - (offset < 0 ? offset : 0)) / NS_PER_SEC)
+        return INT64_MIN;
+    return (int64_t)wall * NS_PER_SEC + offset;
+}
+
+struct timespec clock_to_timespec(int64_t ns)
+{
+    struct timespec ts;
+    if (ns < 0)
+        ns = 0;
+    ts.tv_sec = (time_t)(ns / NS_PER_SEC);
+    ts.tv_nsec = (long)(ns % NS_PER_SEC);
+    return ts;
+}
+
+int clock_cond_init(pthread_cond_t* cond)
+{
+    pthread_condattr_t attr;
+    int ret = pthread_condattr_init(&attr);
+    if (ret != 0)
+        return ret;
+
+    ret = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (ret == 0)
+        ret = pthread_cond_init(cond, &attr);
+
+    pthread_condattr_destroy(&attr);
+    return ret;
+}
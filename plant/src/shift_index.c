@@ -0,0 +1,80 @@
+#include "../headers/shift_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int shift_index_init(shift_index_t* idx, size_t capacity)
+{
+    *idx = (shift_index_t) {0};
+    idx->ends = malloc(sizeof(int64_t) * (capacity > 0 ? capacity : 1));
+    idx->scratch = malloc(sizeof(int64_t) * (capacity > 0 ? capacity : 1));
+    if (!idx->ends || !idx->scratch) {
+        shift_index_destroy(idx);
+        return -1;
+    }
+    idx->capacity = capacity;
+    return 0;
+}
+
+void shift_index_destroy(shift_index_t* idx)
+{
+    free(idx->ends);
+    free(idx->scratch);
+    *idx = (shift_index_t) {0};
+}
+
+void shift_index_add(shift_index_t* idx, int64_t end_ns)
+{
+    if (idx->count < idx->capacity)
+        idx->ends[idx->count++] = end_ns;
+}
+
+static int compare_ends(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Sorts the tail and merges it into the sorted part. */
+static void merge_tail(shift_index_t* idx)
+{
+    size_t n_tail = idx->count - idx->sorted;
+    qsort(idx->ends + idx->sorted, n_tail, sizeof(int64_t), compare_ends);
+
+    size_t i = 0, j = idx->sorted, k = 0;
+    while (i < idx->sorted && j < idx->count)
+        idx->scratch[k++] = idx->ends[i] <= idx->ends[j] ? idx->ends[i++] : idx->ends[j++];
+    while (i < idx->sorted)
+        idx->scratch[k++] = idx->ends[i++];
+    while (j < idx->count)
+        idx->scratch[k++] = idx->ends[j++];
+
+    memcpy(idx->ends, idx->scratch, sizeof(int64_t) * idx->count);
+    idx->sorted = idx->count;
+}
+
+size_t shift_index_ended_by(shift_index_t* idx, int64_t t)
+{
+    if (idx->sorted < idx->count)
+        merge_tail(idx);
+
+    /* Upper bound of `t`. */
+    size_t lo = 0;
+    size_t hi = idx->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (idx->ends[mid] <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+const int64_t* shift_index_after(shift_index_t* idx, int64_t t, size_t* n)
+{
+    size_t ended = shift_index_ended_by(idx, t);
+    *n = idx->count - ended;
+    return idx->ends + ended;
+}
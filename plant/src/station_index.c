@@ -0,0 +1,211 @@
+#include "../headers/station_index.h"
+
+#include <stdlib.h>
+
+typedef struct {
+    int capacity;
+    int station;
+} station_entry_t;
+
+static int compare_entries(const void* a, const void* b)
+{
+    const station_entry_t* x = a;
+    const station_entry_t* y = b;
+    if (x->capacity != y->capacity)
+        return x->capacity < y->capacity ? -1 : 1;
+    return x->station - y->station;
+}
+
+static void tree_add(station_index_t* idx, int bucket, int delta)
+{
+    int node = bucket + idx->tree_leaves;
+    while (node > 0) {
+        idx->tree[node] += delta;
+        node /= 2;
+    }
+}
+
+/* First bucket >= `from` with a free station, -1 if there is none. */
+static int tree_first_free(const station_index_t* idx, int from)
+{
+    if (from >= idx->n_buckets)
+        return -1;
+
+    int node = from + idx->tree_leaves;
+    if (idx->tree[node] > 0)
+        return from;
+
+    while (node > 1) {
+        if (node % 2 == 0 && idx->tree[node + 1] > 0) {
+            node++;
+            while (node < idx->tree_leaves)
+                node = idx->tree[2 * node] > 0 ? 2 * node : 2 * node + 1;
+            return node - idx->tree_leaves;
+        }
+        node /= 2;
+    }
+    return -1;
+}
+
+int station_index_init(station_index_t* idx, const int* capacities, int n_stations)
+{
+    *idx = (station_index_t) {0};
+    idx->max_capacity = 0;
+
+    station_entry_t* entries = malloc(sizeof(station_entry_t) * (n_stations > 0 ? n_stations : 1));
+    if (!entries)
+        return -1;
+
+    for (int i = 0; i < n_stations; i++) {
+        entries[i].capacity = capacities[i];
+        entries[i].station = i;
+    }
+    qsort(entries, n_stations, sizeof(station_entry_t), compare_entries);
+
+    int n_buckets = 0;
+    for (int i = 0; i < n_stations; i++) {
+        if (i == 0 || entries[i].capacity != entries[i - 1].capacity)
+            n_buckets++;
+    }
+
+    int leaves = 1;
+    while (leaves < n_buckets)
+        leaves *= 2;
+
+    idx->n_buckets = n_buckets;
+    idx->tree_leaves = leaves;
+    idx->bucket_capacity = malloc(sizeof(int) * (n_buckets + 1));
+    idx->bucket_start = malloc(sizeof(int) * (n_buckets + 1));
+    idx->free_count = calloc(n_buckets + 1, sizeof(int));
+    idx->free_stations = malloc(sizeof(int) * (n_stations + 1));
+    idx->station_bucket = malloc(sizeof(int) * (n_stations + 1));
+    idx->tree = calloc(2 * leaves, sizeof(int));
+
+    if (!idx->bucket_capacity || !idx->bucket_start || !idx->free_count ||
+        !idx->free_stations || !idx->station_bucket || !idx->tree) {
+        free(entries);
+        station_index_destroy(idx);
+        return -1;
+    }
+
+    int bucket = -1;
+    for (int i = 0; i < n_stations; i++) {
+        if (i == 0 || entries[i].capacity != entries[i - 1].capacity) {
+            bucket++;
+            idx->bucket_capacity[bucket] = entries[i].capacity;
+            idx->bucket_start[bucket] = i;
+        }
+        idx->free_stations[i] = entries[i].station;
+        idx->station_bucket[entries[i].station] = bucket;
+        idx->free_count[bucket]++;
+        tree_add(idx, bucket, 1);
+    }
+
+    if (n_buckets > 0)
+        idx->max_capacity = idx->bucket_capacity[n_buckets - 1];
+
+    free(entries);
+    return 0;
+}
+
+void station_index_destroy(station_index_t* idx)
+{
+    free(idx->bucket_capacity);
+    free(idx->bucket_start);
+    free(idx->free_count);
+    free(idx->free_stations);
+    free(idx->station_bucket);
+    free(idx->tree);
+    *idx = (station_index_t) {0};
+}
+
+bool station_index_fits(const station_index_t* idx, int needed)
+{
+    return idx->n_buckets > 0 && needed <= idx->max_capacity;
+}
+
+/* Lower bound on the bucket capacities. */
+static int first_fitting_bucket(const station_index_t* idx, int needed)
+{
+    int lo = 0;
+    int hi = idx->n_buckets;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->bucket_capacity[mid] < needed)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int station_index_acquire(station_index_t* idx, int needed)
+{
+    if (!station_index_fits(idx, needed))
+        return -1;
+
+    int bucket = tree_first_free(idx, first_fitting_bucket(idx, needed));
+    if (bucket == -1)
+        return -1;
+
+    idx->free_count[bucket]--;
+    tree_add(idx, bucket, -1);
+    return idx->free_stations[idx->bucket_start[bucket] + idx->free_count[bucket]];
+}
+
+void station_index_release(station_index_t* idx, int station)
+{
+    int bucket = idx->station_bucket[station];
+
+    idx->free_stations[idx->bucket_start[bucket] + idx->free_count[bucket]] = station;
+    idx->free_count[bucket]++;
+    tree_add(idx, bucket, 1);
+}
+
+int station_index_peek(const station_index_t* idx, int needed)
+{
+    if (!station_index_fits(idx, needed))
+        return -1;
+
+    int bucket = tree_first_free(idx, first_fitting_bucket(idx, needed));
+    if (bucket == -1)
+        return -1;
+    return idx->free_stations[idx->bucket_start[bucket] + idx->free_count[bucket] - 1];
+}
+
+int station_index_free_fitting(const station_index_t* idx, int needed)
+{
+    if (!station_index_fits(idx, needed))
+        return 0;
+
+    /* Sum over the leaves [first fitting, end), unused leaves hold 0. */
+    int count = 0;
+    int lo = first_fitting_bucket(idx, needed) + idx->tree_leaves;
+    int hi = 2 * idx->tree_leaves;
+    while (lo < hi) {
+        if (lo % 2 == 1)
+            count += idx->tree[lo++];
+        if (hi % 2 == 1)
+            count += idx->tree[--hi];
+        lo /= 2;
+        hi /= 2;
+    }
+    return count;
+}
+
+int station_index_max_free(const station_index_t* idx)
+{
+    if (idx->tree == NULL || idx->tree[1] == 0)
+        return 0;
+
+    int node = 1;
+    while (node < idx->tree_leaves)
+        node = idx->tree[2 * node + 1] > 0 ? 2 * node + 1 : 2 * node;
+    return idx->bucket_capacity[node - idx->tree_leaves];
+}
+
+int station_index_free_count(const station_index_t* idx)
+{
+    /* The root counts the free stations of every bucket. */
+    return idx->tree ? idx->tree[1] : 0;
+}
@@ -0,0 +1,28 @@
+#include "../headers/stats.h"
+
+/* Shard of the calling thread, picked round robin on its first add. */
+static _Thread_local int thread_shard = -1;
+static atomic_int next_shard;
+
+void stats_init(stats_t* stats)
+{
+    for (int i = 0; i < STATS_SHARDS; i++) {
+        for (int j = 0; j < STAT_COUNT; j++)
+            atomic_init(&stats->shards[i].values[j], 0);
+    }
+}
+
+void stats_add(stats_t* stats, stat_t stat, int64_t value)
+{
+    if (thread_shard == -1)
+        thread_shard = atomic_fetch_add_explicit(&next_shard, 1, memory_order_relaxed) % STATS_SHARDS;
+    atomic_fetch_add_explicit(&stats->shards[thread_shard].values[stat], value, memory_order_relaxed);
+}
+
+int64_t stats_read(const stats_t* stats, stat_t stat)
+{
+    int64_t sum = 0;
+    for (int i = 0; i < STATS_SHARDS; i++)
+        sum += atomic_load_explicit(&stats->shards[i].values[stat], memory_order_relaxed);
+    return sum;
+}
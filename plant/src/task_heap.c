@@ -0,0 +1,147 @@
+#include "../headers/task_heap.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+bool task_heap_by_start(const task_info_t* a, const task_info_t* b)
+{
+    return a->attr.start_ns < b->attr.start_ns;
+}
+
+/* No deadline sorts after every deadline. */
+static int64_t deadline_key(const task_info_t* task)
+{
+    return task->attr.deadline_ns != 0 ? task->attr.deadline_ns : INT64_MAX;
+}
+
+bool task_heap_by_priority(const task_info_t* a, const task_info_t* b)
+{
+    if (a->attr.priority != b->attr.priority)
+        return a->attr.priority > b->attr.priority;
+    if (deadline_key(a) != deadline_key(b))
+        return deadline_key(a) < deadline_key(b);
+    return a->seq < b->seq;
+}
+
+static void heap_set(task_heap_t* heap, size_t pos, task_info_t* task)
+{
+    heap->items[pos] = task;
+    task->heap_pos = pos;
+}
+
+static void heap_sift_up(task_heap_t* heap, size_t pos)
+{
+    task_info_t* task = heap->items[pos];
+
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!heap->before(task, heap->items[parent]))
+            break;
+        heap_set(heap, pos, heap->items[parent]);
+        pos = parent;
+    }
+    heap_set(heap, pos, task);
+}
+
+static void heap_sift_down(task_heap_t* heap, size_t pos)
+{
+    task_info_t* task = heap->items[pos];
+
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap->count)
+            break;
+        if (child + 1 < heap->count &&
+            heap->before(heap->items[child + 1], heap->items[child]))
+            child++;
+        if (!heap->before(heap->items[child], task))
+            break;
+        heap_set(heap, pos, heap->items[child]);
+        pos = child;
+    }
+    heap_set(heap, pos, task);
+}
+
+int task_heap_init(task_heap_t* heap, task_heap_before_t before, task_sched_t sched)
+{
+    heap->before = before;
+    heap->sched = sched;
+    heap->capacity = 4;
+    heap->count = 0;
+    heap->items = malloc(heap->capacity * sizeof(task_info_t*));
+    if (heap->items == NULL) {
+        heap->capacity = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void task_heap_destroy(task_heap_t* heap)
+{
+    free(heap->items);
+    heap->items = NULL;
+    heap->capacity = 0;
+    heap->count = 0;
+}
+
+int task_heap_push(task_heap_t* heap, task_info_t* task)
+{
+    if (heap->count >= heap->capacity) {
+        size_t new_capacity = heap->capacity * 2;
+        task_info_t** new_items = realloc(heap->items, new_capacity * sizeof(task_info_t*));
+        if (new_items == NULL)
+            return -1;
+
+        heap->items = new_items;
+        heap->capacity = new_capacity;
+    }
+
+    task->sched = heap->sched;
+    heap_set(heap, heap->count++, task);
+    heap_sift_up(heap, task->heap_pos);
+    return 0;
+}
+
+task_info_t* task_heap_top(const task_heap_t* heap)
+{
+    return heap->count > 0 ? heap->items[0] : NULL;
+}
+
+task_info_t* task_heap_pop(task_heap_t* heap)
+{
+    task_info_t* top = task_heap_top(heap);
+    if (top != NULL)
+        task_heap_remove(heap, top);
+    return top;
+}
+
+void task_heap_remove(task_heap_t* heap, task_info_t* task)
+{
+    size_t pos = task->heap_pos;
+
+    task->sched = SCHED_NONE;
+    heap->count--;
+    if (pos == heap->count)
+        return;
+
+    task_info_t* moved = heap->items[heap->count];
+    heap_set(heap, pos, moved);
+    heap_sift_up(heap, pos);
+    heap_sift_down(heap, moved->heap_pos);
+}
+
+void task_heap_remove_completed(task_heap_t* heap)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < heap->count; i++) {
+        task_info_t* task = heap->items[i];
+        if (task_info_completed(task))
+            task->sched = SCHED_NONE;
+        else
+            heap_set(heap, kept++, task);
+    }
+    heap->count = kept;
+
+    for (size_t i = kept / 2; i-- > 0;)
+        heap_sift_down(heap, i);
+}
@@ -1,18 +1,34 @@
 #include "../headers/task_info.h"
-#include "../../common/err.h"
 
-int task_info_init(task_info_t* info, task_t* task_def)
+#include <stdlib.h>
+
+void task_info_reset(task_info_t* info, task_t* task_def)
 {
     info->original_def = task_def;
+    info->completion = 0;
     info->workers_assigned = 0;
-    info->is_completed = false;
+    info->n_workers = 0;
+    info->assigned_position = -1;
+    info->sched = SCHED_NONE;
+    info->heap_pos = 0;
     info->failed = false;
+    info->staging = false;
+    info->pending_release = false;
+    info->collectors = 0;
+    info->collected = false;
+    info->callback = NULL;
+    info->callback_arg = NULL;
+    info->cont_pos = 0;
+    info->next_free = NULL;
+}
 
-    if (pthread_cond_init(&info->task_complete_cond, NULL) != 0) {
-        info->original_def = NULL;
-        return -1;
-    }
-
+/* Nothing to set up besides the fields, so this can't fail anymore. */
+int task_info_init(task_info_t* info, task_t* task_def)
+{
+    info->slots = NULL;
+    info->n_slots = 0;
+    atomic_init(&info->publishers, 0);
+    task_info_reset(info, task_def);
     return 0;
 }
 
@@ -21,7 +37,31 @@ void task_info_destroy(task_info_t* info)
     info->original_def = NULL;
     info->workers_assigned = 0;
     /* Manager will ignore it */
-    info->is_completed = true;
+    info->completion = TASK_DONE;
     info->failed = false;
-    ASSERT_ZERO(pthread_cond_destroy(&info->task_complete_cond));
+    free(info->slots);
+    info->slots = NULL;
+    info->n_slots = 0;
+}
+
+int task_info_stage_results(task_info_t* info)
+{
+    int needed = info->original_def->capacity;
+    if (needed > info->n_slots) {
+        result_slot_t* slots = aligned_alloc(CACHE_LINE, sizeof(result_slot_t) * needed);
+        if (slots == NULL)
+            return -1;
+        free(info->slots);
+        info->slots = slots;
+        info->n_slots = needed;
+    }
+    info->staging = true;
+    return 0;
+}
+
+void task_info_gather_results(task_info_t* info)
+{
+    int* results = info->original_def->results;
+    for (int i = 0; i < info->original_def->capacity; i++)
+        results[i] = info->slots[i].value;
 }
\ No newline at end of file
@@ -3,29 +3,72 @@
 #include <stdio.h>
 #include "../headers/task_list.h"
 
+#define TASK_CONT_MIN_CAPACITY 4
+
 int task_cont_init(task_container* cont)
 {
-    cont->capacity = 4;
+    cont->capacity = TASK_CONT_MIN_CAPACITY;
     cont->count = 0;
+    cont->free_list = NULL;
+    cont->free_count = 0;
     cont->waiting_ans = 0;
 
     cont->items = malloc(cont->capacity * sizeof(task_info_t*));
 
     if (cont->items == NULL) 
         return -1;
+
+    if (id_map_init(&cont->index, cont->capacity) != 0) {
+        free(cont->items);
+        cont->items = NULL;
+        return -1;
+    }
     return 0;
 }
 
+task_info_t* task_cont_new_task(task_container* cont, task_t* task_def)
+{
+    task_info_t* task = cont->free_list;
+    if (task != NULL) {
+        cont->free_list = task->next_free;
+        cont->free_count--;
+        task_info_reset(task, task_def);
+        return task;
+    }
+
+    task = calloc(1, sizeof(task_info_t));
+    if (task == NULL)
+        return NULL;
+
+    if (task_info_init(task, task_def) != 0) {
+        free(task);
+        return NULL;
+    }
+    return task;
+}
+
+void task_cont_recycle(task_container* cont, task_info_t* task)
+{
+    /* Kept past the limit while a publisher may still wake on it. */
+    if (cont->free_count >= TASK_FREE_LIST_MAX &&
+        atomic_load_explicit(&task->publishers, memory_order_acquire) == 0) {
+        task_info_destroy(task);
+        free(task);
+        return;
+    }
+
+    task_info_reset(task, NULL);
+    task->next_free = cont->free_list;
+    cont->free_list = task;
+    cont->free_count++;
+}
+
 int task_cont_push_back(task_container* cont, task_info_t* task)
 {
     int id = task->original_def->id;
-    for (size_t i = 0; i < cont->count; i++) {
-        int cur_id = cont->items[i]->original_def->id;
-        if (id == cur_id) {
-            task_info_destroy(task);
-            free(task);
-            return 0;
-        }
+    if (id_map_get(&cont->index, id) != NULL) {
+        task_cont_recycle(cont, task);
+        return 0;
     }
     if (cont->count >= cont->capacity) {
         int new_capacity = cont->capacity * 2;
@@ -39,17 +82,48 @@ int task_cont_push_back(task_container* cont, task_info_t* task)
         cont->capacity = new_capacity;
     }
 
+    if (id_map_put(&cont->index, id, task) != 0)
+        return -1;
+
+    task->cont_pos = cont->count;
     cont->items[cont->count] = task;
     cont->count++;
     return 0;
 }
 
+void task_cont_remove(task_container* cont, task_info_t* task)
+{
+    size_t pos = task->cont_pos;
+
+    id_map_remove(&cont->index, task->original_def->id);
+    cont->count--;
+    if (pos != cont->count) {
+        cont->items[pos] = cont->items[cont->count];
+        cont->items[pos]->cont_pos = pos;
+    }
+
+    /* Give memory back once the container is mostly empty. */
+    if (cont->capacity > TASK_CONT_MIN_CAPACITY && cont->count * 4 <= cont->capacity) {
+        int new_capacity = cont->capacity / 2;
+        task_info_t** new_items = realloc(cont->items, new_capacity * sizeof(task_info_t*));
+        if (new_items != NULL) {
+            cont->items = new_items;
+            cont->capacity = new_capacity;
+        }
+    }
+}
+
 task_info_t* task_cont_get(task_container* cont, size_t index)
 {
     if (index >= cont->count) return NULL;
     return cont->items[index];
 }
 
+task_info_t* task_cont_find(task_container* cont, int id)
+{
+    return id_map_get(&cont->index, id);
+}
+
 size_t task_cont_size(task_container* cont)
 {
     return cont->count;
@@ -63,7 +137,16 @@ void task_cont_destroy(task_container* cont)
         free(cont->items[i]);
     }
 
+    while (cont->free_list != NULL) {
+        task_info_t* next = cont->free_list->next_free;
+        task_info_destroy(cont->free_list);
+        free(cont->free_list);
+        cont->free_list = next;
+    }
+    cont->free_count = 0;
+
     free(cont->items);
+    id_map_destroy(&cont->index);
     cont->items = NULL;
     cont->count = 0;
     cont->capacity = 0;
@@ -0,0 +1,111 @@
+#include "../headers/task_queue.h"
+
+#include <stdlib.h>
+
+int task_queue_init(task_queue_t* queue)
+{
+    queue->capacity = 4;
+    queue->head = 0;
+    queue->count = 0;
+    queue->items = malloc(queue->capacity * sizeof(task_info_t*));
+    if (queue->items == NULL) {
+        queue->capacity = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void task_queue_destroy(task_queue_t* queue)
+{
+    free(queue->items);
+    queue->items = NULL;
+    queue->capacity = 0;
+    queue->head = 0;
+    queue->count = 0;
+}
+
+int task_queue_push(task_queue_t* queue, task_info_t* task)
+{
+    if (queue->count >= queue->capacity) {
+        size_t new_capacity = queue->capacity * 2;
+        task_info_t** new_items = malloc(new_capacity * sizeof(task_info_t*));
+        if (new_items == NULL)
+            return -1;
+
+        for (size_t i = 0; i < queue->count; i++)
+            new_items[i] = queue->items[(queue->head + i) % queue->capacity];
+
+        free(queue->items);
+        queue->items = new_items;
+        queue->capacity = new_capacity;
+        queue->head = 0;
+    }
+
+    task->sched = SCHED_READY;
+    queue->items[(queue->head + queue->count) % queue->capacity] = task;
+    queue->count++;
+    return 0;
+}
+
+task_info_t* task_queue_pop(task_queue_t* queue)
+{
+    if (queue->count == 0)
+        return NULL;
+
+    task_info_t* task = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    task->sched = SCHED_NONE;
+    return task;
+}
+
+size_t task_queue_size(const task_queue_t* queue)
+{
+    return queue->count;
+}
+
+task_info_t* task_queue_at(const task_queue_t* queue, size_t i)
+{
+    return queue->items[(queue->head + i) % queue->capacity];
+}
+
+task_info_t* task_queue_take(task_queue_t* queue, size_t i)
+{
+    size_t pos = (queue->head + i) % queue->capacity;
+    task_info_t* task = queue->items[pos];
+    queue->items[pos] = NULL;
+    task->sched = SCHED_NONE;
+    return task;
+}
+
+void task_queue_put_back(task_queue_t* queue, size_t i, task_info_t* task)
+{
+    task->sched = SCHED_READY;
+    queue->items[(queue->head + i) % queue->capacity] = task;
+}
+
+/* The tasks are moved towards the back, so only the `n` places are touched. */
+void task_queue_close_gaps(task_queue_t* queue, size_t n)
+{
+    size_t kept = 0;
+    for (size_t i = n; i-- > 0;) {
+        task_info_t* task = queue->items[(queue->head + i) % queue->capacity];
+        if (task != NULL)
+            queue->items[(queue->head + n - 1 - kept++) % queue->capacity] = task;
+    }
+    queue->head = (queue->head + n - kept) % queue->capacity;
+    queue->count -= n - kept;
+}
+
+void task_queue_remove_completed(task_queue_t* queue)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < queue->count; i++) {
+        task_info_t* task = task_queue_at(queue, i);
+        if (task_info_completed(task))
+            task->sched = SCHED_NONE;
+        else
+            queue->items[(queue->head + kept++) % queue->capacity] = task;
+    }
+    queue->count = kept;
+}
@@ -0,0 +1,262 @@
+#include "../headers/trace.h"
+#include "../../common/err.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    int64_t ts;
+    int tid;
+    int task;
+    int arg;
+    trace_type_t type;
+} trace_event_t;
+
+/* An event the dump may read while the owner overwrites it. `seq` is the
+   event's index + 1 once written and 0 while it is being written, so the
+   dump can tell a torn copy. */
+typedef struct {
+    atomic_ullong seq;
+    atomic_llong ts;
+    atomic_int tid;
+    atomic_int task;
+    atomic_int arg;
+    atomic_int type;
+} trace_slot_t;
+
+/* Owned by one thread at a time, rings of exited threads are handed to new
+   ones. Only the owner writes, `count` publishes its events to the dump.
+   `count` never goes back, a new trace starts at `first`, which the owner
+   sets once it sees the new `generation`. A ring of another capacity than
+   the current one is replaced by its owner. */
+typedef struct trace_ring {
+    struct trace_ring* next;
+    struct trace_ring* next_free;
+    atomic_ullong count;
+    atomic_ullong first;
+    atomic_uint generation;
+    int capacity;
+    trace_slot_t slots[];
+} trace_ring_t;
+
+atomic_bool trace_on;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Every ring in use or free, they are only freed when the capacity changes. */
+static trace_ring_t* rings;
+static trace_ring_t* free_rings;
+static atomic_int ring_capacity;
+/* Bumped by every trace_start(), under registry_lock. */
+static atomic_uint trace_generation;
+
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+static atomic_int next_tid;
+
+static _Thread_local trace_ring_t* my_ring;
+static _Thread_local int my_tid;
+
+static void release_ring(void* ring)
+{
+    ASSERT_ZERO(pthread_mutex_lock(&registry_lock));
+    ((trace_ring_t*)ring)->next_free = free_rings;
+    free_rings = ring;
+    ASSERT_ZERO(pthread_mutex_unlock(&registry_lock));
+}
+
+static void create_key(void)
+{
+    if (pthread_key_create(&ring_key, release_ring) != 0)
+        abort();
+}
+
+/* Done under registry_lock, by the owner of `ring` if it has one. */
+static void drop_ring(trace_ring_t* ring)
+{
+    trace_ring_t** link = &rings;
+    while (*link != ring)
+        link = &(*link)->next;
+    *link = ring->next;
+    free(ring);
+}
+
+/* Drops the free rings of another capacity. Done under registry_lock. */
+static void drop_free_rings(int capacity)
+{
+    trace_ring_t** link = &free_rings;
+    while (*link != NULL) {
+        trace_ring_t* ring = *link;
+        if (ring->capacity == capacity) {
+            link = &ring->next_free;
+        } else {
+            *link = ring->next_free;
+            drop_ring(ring);
+        }
+    }
+}
+
+/* Gives the calling thread a ring of the current capacity, in place of `old`. */
+static trace_ring_t* acquire_ring(trace_ring_t* old)
+{
+    ASSERT_ZERO(pthread_once(&key_once, create_key));
+    ASSERT_ZERO(pthread_mutex_lock(&registry_lock));
+
+    int capacity = atomic_load(&ring_capacity);
+    if (old != NULL)
+        drop_ring(old);
+    drop_free_rings(capacity);
+
+    trace_ring_t* ring = free_rings;
+    if (ring != NULL) {
+        free_rings = ring->next_free;
+    } else {
+        ring = malloc(sizeof(trace_ring_t) + sizeof(trace_slot_t) * capacity);
+        if (ring != NULL) {
+            atomic_init(&ring->count, 0);
+            atomic_init(&ring->first, 0);
+            atomic_init(&ring->generation, 0);
+            for (int i = 0; i < capacity; i++)
+                atomic_init(&ring->slots[i].seq, 0);
+            ring->capacity = capacity;
+            ring->next = rings;
+            rings = ring;
+        }
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&registry_lock));
+    /* Without a new ring this clears the dropped one from the key. */
+    if (pthread_setspecific(ring_key, ring) != 0)
+        ring = NULL;
+    my_ring = ring;
+    if (ring == NULL)
+        return NULL;
+
+    if (old == NULL)
+        my_tid = atomic_fetch_add(&next_tid, 1) + 1;
+    return ring;
+}
+
+void trace_record(trace_type_t type, int64_t ts, int task, int arg)
+{
+    trace_ring_t* ring = my_ring;
+    if ((ring == NULL || ring->capacity != atomic_load_explicit(&ring_capacity, memory_order_relaxed)) &&
+        (ring = acquire_ring(ring)) == NULL)
+        return;
+
+    unsigned long long n = atomic_load_explicit(&ring->count, memory_order_relaxed);
+    unsigned generation = atomic_load_explicit(&trace_generation, memory_order_relaxed);
+    if (atomic_load_explicit(&ring->generation, memory_order_relaxed) != generation) {
+        atomic_store_explicit(&ring->first, n, memory_order_relaxed);
+        atomic_store_explicit(&ring->generation, generation, memory_order_release);
+    }
+
+    /* A seqlock of one slot. The fields are released, so a dump that reads
+       any of them also sees the slot marked in flight. */
+    trace_slot_t* slot = &ring->slots[n % ring->capacity];
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&slot->ts, ts, memory_order_release);
+    atomic_store_explicit(&slot->tid, my_tid, memory_order_release);
+    atomic_store_explicit(&slot->task, task, memory_order_release);
+    atomic_store_explicit(&slot->arg, arg, memory_order_release);
+    atomic_store_explicit(&slot->type, type, memory_order_release);
+    atomic_store_explicit(&slot->seq, n + 1, memory_order_release);
+    atomic_store_explicit(&ring->count, n + 1, memory_order_release);
+}
+
+int trace_start(int capacity)
+{
+    if (capacity <= 0)
+        return -1;
+
+    /* Owners may be recording, so the rings are left to them. Each skips
+       what it recorded so far on its next event. */
+    ASSERT_ZERO(pthread_mutex_lock(&registry_lock));
+    atomic_store(&ring_capacity, capacity);
+    atomic_fetch_add(&trace_generation, 1);
+    drop_free_rings(capacity);
+    ASSERT_ZERO(pthread_mutex_unlock(&registry_lock));
+
+    atomic_store(&trace_on, true);
+    return 0;
+}
+
+void trace_stop(void)
+{
+    atomic_store(&trace_on, false);
+}
+
+static void write_event(FILE* out, const trace_event_t* e, bool first)
+{
+    static const char* const names[] = {
+        [TRACE_ADD_TASK] = "add_task",
+        [TRACE_ASSIGN] = "assign",
+        [TRACE_WORK_BEGIN] = "work",
+        [TRACE_WORK_END] = "work",
+        [TRACE_COMPLETED] = "completed",
+        [TRACE_COLLECTED] = "collected",
+    };
+    static const char* const args[] = {
+        [TRACE_ADD_TASK] = "",
+        [TRACE_ASSIGN] = "station",
+        [TRACE_WORK_BEGIN] = "worker",
+        [TRACE_WORK_END] = "worker",
+        [TRACE_COMPLETED] = "failed",
+        [TRACE_COLLECTED] = "status",
+    };
+
+    const char* phase = e->type == TRACE_WORK_BEGIN ? "\"B\"" :
+                        e->type == TRACE_WORK_END ? "\"E\"" : "\"i\", \"s\": \"t\"";
+    fprintf(out, "%s\n{\"name\": \"%s\", \"ph\": %s, \"ts\": %.3f, \"pid\": 1, \"tid\": %d, "
+            "\"args\": {\"task\": %d",
+            first ? "" : ",", names[e->type], phase, e->ts / 1000.0, e->tid, e->task);
+    if (args[e->type][0] != '\0')
+        fprintf(out, ", \"%s\": %d", args[e->type], e->arg);
+    fprintf(out, "}}");
+}
+
+/* Copies event `i` out of its slot, false if the owner got to it meanwhile. */
+static bool read_slot(trace_slot_t* slot, unsigned long long i, trace_event_t* e)
+{
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != i + 1)
+        return false;
+    e->ts = atomic_load_explicit(&slot->ts, memory_order_acquire);
+    e->tid = atomic_load_explicit(&slot->tid, memory_order_acquire);
+    e->task = atomic_load_explicit(&slot->task, memory_order_acquire);
+    e->arg = atomic_load_explicit(&slot->arg, memory_order_acquire);
+    e->type = atomic_load_explicit(&slot->type, memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == i + 1;
+}
+
+int trace_dump(const char* path)
+{
+    FILE* out = fopen(path, "w");
+    if (out == NULL)
+        return -1;
+
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    bool first = true;
+
+    ASSERT_ZERO(pthread_mutex_lock(&registry_lock));
+    unsigned generation = atomic_load(&trace_generation);
+    for (trace_ring_t* ring = rings; ring != NULL; ring = ring->next) {
+        /* Nothing recorded since the trace started. */
+        if (atomic_load_explicit(&ring->generation, memory_order_acquire) != generation)
+            continue;
+        unsigned long long from = atomic_load_explicit(&ring->first, memory_order_relaxed);
+        unsigned long long n = atomic_load_explicit(&ring->count, memory_order_acquire);
+        if (n - from > (unsigned long long)ring->capacity)
+            from = n - ring->capacity;
+        for (unsigned long long i = from; i < n; i++) {
+            trace_event_t e;
+            if (read_slot(&ring->slots[i % ring->capacity], i, &e)) {
+                write_event(out, &e, first);
+                first = false;
+            }
+        }
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&registry_lock));
+
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0 ? 0 : -1;
+}
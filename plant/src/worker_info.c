@@ -1,12 +1,26 @@
 #include "../headers/worker_info.h"
+#include "../headers/plant_clock.h"
 #include "../../common/err.h"
 
 int worker_info_init(worker_info_t* info, worker_t* worker_def)
 {
     info->original_def = worker_def;
     info->assigned_task = NULL;
+    info->pool_state = POOL_NONE;
+    info->pool_pos = 0;
+    info->last_station = -1;
+    info->station_prev = NULL;
+    info->station_next = NULL;
+    info->next_job = NULL;
+    CPU_ZERO(&info->cpus);
 
-    if (pthread_cond_init(&info->wakeup_cond, NULL) != 0) {
+    if (pthread_mutex_init(&info->lock, NULL) != 0) {
+        info->original_def = NULL;
+        return -1;
+    }
+
+    if (clock_cond_init(&info->wakeup_cond) != 0) {
+        ASSERT_ZERO(pthread_mutex_destroy(&info->lock));
         info->original_def = NULL;
         info->assigned_task = NULL;
         return -1;
@@ -20,4 +34,5 @@ void worker_info_destroy(worker_info_t* info)
     info->assigned_task = NULL;
 
     ASSERT_ZERO(pthread_cond_destroy(&info->wakeup_cond));
+    ASSERT_ZERO(pthread_mutex_destroy(&info->lock));
 }
\ No newline at end of file
@@ -12,23 +12,44 @@ int worker_cont_init(worker_container* list, size_t n_workers)
         list->capacity = 0;
         return -1;
     }
+
+    if (id_map_init(&list->index, n_workers) != 0) {
+        free(list->items);
+        list->items = NULL;
+        list->capacity = 0;
+        return -1;
+    }
     return 0;
 }
 
-void worker_cont_push_back(worker_container* list, worker_info_t* worker)
+int worker_cont_push_back(worker_container* list, worker_info_t* worker)
 {
     int id = worker->original_def->id;
-    for(size_t i = 0; i < list->count; i++) {
-        int curid = list->items[i]->original_def->id;
-        if (id == curid) {
-            worker_info_destroy(worker);
-            free(worker);
-            return;
-        }
+    if (id_map_get(&list->index, id) != NULL) {
+        worker_info_destroy(worker);
+        free(worker);
+        return 0;
     }
 
+    /* All `n_workers` slots are taken. */
+    if (list->count >= list->capacity)
+        return -1;
+
+    if (id_map_put(&list->index, id, worker) != 0)
+        return -1;
+
     list->items[list->count] = worker;
     list->count++;
+    return 0;
+}
+
+/* Forgets the most recently pushed worker, doesn't free it. */
+void worker_cont_pop_back(worker_container* list)
+{
+    if (list->count == 0) return;
+
+    list->count--;
+    id_map_remove(&list->index, list->items[list->count]->original_def->id);
 }
 
 size_t worker_cont_size(worker_container* cont)
@@ -42,6 +63,11 @@ worker_info_t* worker_cont_get(worker_container* list, size_t index)
     return list->items[index];
 }
 
+worker_info_t* worker_cont_find(worker_container* list, int id)
+{
+    return id_map_get(&list->index, id);
+}
+
 void worker_cont_free(worker_container* list)
 {
     for (size_t i = 0; i < list->count; i++) {
@@ -50,6 +76,7 @@ void worker_cont_free(worker_container* list)
     }
 
     free(list->items);
+    id_map_destroy(&list->index);
     list->items = NULL;
     list->count = 0;
     list->capacity = 0;
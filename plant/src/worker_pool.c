@@ -0,0 +1,210 @@
+#include "../headers/worker_pool.h"
+
+#include <stdlib.h>
+
+static int64_t heap_key(const worker_pool_t* pool, const worker_heap_t* heap, const worker_info_t* w)
+{
+    return heap == &pool->on_shift ? w->attr.end_ns : w->attr.start_ns;
+}
+
+static void heap_set(worker_heap_t* heap, size_t pos, worker_info_t* w)
+{
+    heap->items[pos] = w;
+    w->pool_pos = pos;
+}
+
+static void heap_sift_up(const worker_pool_t* pool, worker_heap_t* heap, size_t pos)
+{
+    worker_info_t* w = heap->items[pos];
+    int64_t key = heap_key(pool, heap, w);
+
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (heap_key(pool, heap, heap->items[parent]) <= key)
+            break;
+        heap_set(heap, pos, heap->items[parent]);
+        pos = parent;
+    }
+    heap_set(heap, pos, w);
+}
+
+static void heap_sift_down(const worker_pool_t* pool, worker_heap_t* heap, size_t pos)
+{
+    worker_info_t* w = heap->items[pos];
+    int64_t key = heap_key(pool, heap, w);
+
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap->count)
+            break;
+        if (child + 1 < heap->count &&
+            heap_key(pool, heap, heap->items[child + 1]) < heap_key(pool, heap, heap->items[child]))
+            child++;
+        if (key <= heap_key(pool, heap, heap->items[child]))
+            break;
+        heap_set(heap, pos, heap->items[child]);
+        pos = child;
+    }
+    heap_set(heap, pos, w);
+}
+
+static void station_link(worker_pool_t* pool, worker_info_t* w)
+{
+    if (w->last_station < 0 || w->last_station >= pool->n_stations)
+        return;
+
+    worker_info_t** head = &pool->station_idle[w->last_station];
+    w->station_prev = NULL;
+    w->station_next = *head;
+    if (*head != NULL)
+        (*head)->station_prev = w;
+    *head = w;
+}
+
+static void station_unlink(worker_pool_t* pool, worker_info_t* w)
+{
+    if (w->last_station < 0 || w->last_station >= pool->n_stations)
+        return;
+
+    if (w->station_prev != NULL)
+        w->station_prev->station_next = w->station_next;
+    else
+        pool->station_idle[w->last_station] = w->station_next;
+    if (w->station_next != NULL)
+        w->station_next->station_prev = w->station_prev;
+    w->station_prev = NULL;
+    w->station_next = NULL;
+}
+
+static void heap_push(worker_pool_t* pool, worker_heap_t* heap, worker_info_t* w, pool_state_t state)
+{
+    w->pool_state = state;
+    heap_set(heap, heap->count++, w);
+    heap_sift_up(pool, heap, w->pool_pos);
+    if (state == POOL_ON_SHIFT)
+        station_link(pool, w);
+}
+
+static void heap_erase(worker_pool_t* pool, worker_heap_t* heap, size_t pos)
+{
+    if (heap->items[pos]->pool_state == POOL_ON_SHIFT)
+        station_unlink(pool, heap->items[pos]);
+    heap->items[pos]->pool_state = POOL_NONE;
+    heap->count--;
+    if (pos == heap->count)
+        return;
+
+    worker_info_t* moved = heap->items[heap->count];
+    heap_set(heap, pos, moved);
+    heap_sift_up(pool, heap, pos);
+    heap_sift_down(pool, heap, moved->pool_pos);
+}
+
+int worker_pool_init(worker_pool_t* pool, size_t capacity, int n_stations)
+{
+    pool->capacity = capacity;
+    pool->n_stations = n_stations;
+    pool->expired = 0;
+    pool->on_shift.count = 0;
+    pool->upcoming.count = 0;
+
+    pool->on_shift.items = malloc(sizeof(worker_info_t*) * (capacity > 0 ? capacity : 1));
+    pool->upcoming.items = malloc(sizeof(worker_info_t*) * (capacity > 0 ? capacity : 1));
+    pool->station_idle = calloc(n_stations > 0 ? n_stations : 1, sizeof(worker_info_t*));
+    if (!pool->on_shift.items || !pool->upcoming.items || !pool->station_idle) {
+        worker_pool_destroy(pool);
+        return -1;
+    }
+    return 0;
+}
+
+void worker_pool_destroy(worker_pool_t* pool)
+{
+    free(pool->on_shift.items);
+    free(pool->upcoming.items);
+    free(pool->station_idle);
+    pool->on_shift.items = NULL;
+    pool->upcoming.items = NULL;
+    pool->station_idle = NULL;
+    pool->n_stations = 0;
+    pool->on_shift.count = 0;
+    pool->upcoming.count = 0;
+    pool->capacity = 0;
+}
+
+bool worker_pool_put(worker_pool_t* pool, worker_info_t* w, int64_t now)
+{
+    if (now >= w->attr.end_ns)
+        return false;
+
+    if (now < w->attr.start_ns)
+        heap_push(pool, &pool->upcoming, w, POOL_UPCOMING);
+    else
+        heap_push(pool, &pool->on_shift, w, POOL_ON_SHIFT);
+    return true;
+}
+
+void worker_pool_remove(worker_pool_t* pool, worker_info_t* w)
+{
+    if (w->pool_state == POOL_ON_SHIFT)
+        heap_erase(pool, &pool->on_shift, w->pool_pos);
+    else if (w->pool_state == POOL_UPCOMING)
+        heap_erase(pool, &pool->upcoming, w->pool_pos);
+}
+
+void worker_pool_advance(worker_pool_t* pool, int64_t now)
+{
+    while (pool->upcoming.count > 0 && pool->upcoming.items[0]->attr.start_ns <= now) {
+        worker_info_t* w = pool->upcoming.items[0];
+        heap_erase(pool, &pool->upcoming, 0);
+        worker_pool_put(pool, w, now);
+    }
+
+    while (pool->on_shift.count > 0 && pool->on_shift.items[0]->attr.end_ns <= now) {
+        heap_erase(pool, &pool->on_shift, 0);
+        pool->expired++;
+    }
+}
+
+size_t worker_pool_available(const worker_pool_t* pool)
+{
+    return pool->on_shift.count;
+}
+
+worker_info_t* worker_pool_take(worker_pool_t* pool)
+{
+    if (pool->on_shift.count == 0)
+        return NULL;
+
+    worker_info_t* w = pool->on_shift.items[0];
+    heap_erase(pool, &pool->on_shift, 0);
+    return w;
+}
+
+worker_info_t* worker_pool_take_near(worker_pool_t* pool, int station)
+{
+    if (station < 0 || station >= pool->n_stations || pool->station_idle[station] == NULL)
+        return worker_pool_take(pool);
+
+    worker_info_t* w = pool->station_idle[station];
+    heap_erase(pool, &pool->on_shift, w->pool_pos);
+    return w;
+}
+
+bool worker_pool_next_start(const worker_pool_t* pool, int64_t* start_ns)
+{
+    if (pool->upcoming.count == 0)
+        return false;
+
+    *start_ns = pool->upcoming.items[0]->attr.start_ns;
+    return true;
+}
+
+bool worker_pool_next_end(const worker_pool_t* pool, int64_t* end_ns)
+{
+    if (pool->on_shift.count == 0)
+        return false;
+
+    *end_ns = pool->on_shift.items[0]->attr.end_ns;
+    return true;
+}